@@ -1,10 +1,167 @@
 #include "AES.h"
-#include <sstream>
-#include <iomanip>
-#include <iostream>
+#include "AES_NI.h"
 #include <string>
+#include <algorithm>
+#include <cstdlib>
 #include <QDebug>
 
+namespace {
+using AES_Operation::S_Box;
+using AES_Operation::Inv_S_Box;
+
+/*
+ *  有限域GF(2^8)上的乘法,只在编译期生成查找表时使用
+ */
+constexpr AES::Byte GFMultiply(AES::Byte a, AES::Byte b)
+{
+    AES::Byte ret = 0;
+    for(int counter = 0; counter < 8; ++counter){
+        if(b & 1)
+            ret ^= a;
+        a = static_cast<AES::Byte>((a << 1) ^ ((a & 0x80) ? 0x1b : 0x00)); /* x^8 + x^4 + x^3 + x + 1 */
+        b >>= 1;
+    }
+    return ret;
+}
+
+constexpr AES::Word RotateRight(AES::Word w, int bits)
+{
+    return bits ? (w >> bits) | (w << (32-bits)) : w;
+}
+
+/*
+ *  T表:把字节代替、行移位和列混淆合并为每列4次查表。
+ *  Te[0][x]为S(x)乘以列混淆矩阵第一列(02,01,01,03)得到的字,Te[j]是它循环右移8j位;
+ *  Td同理对应逆S盒与逆列混淆矩阵(0e,09,0d,0b)
+ */
+struct Tables
+{
+    AES::Word Te[4][256];
+    AES::Word Td[4][256];
+    AES::Byte Sbox[256];
+    AES::Byte InvSbox[256];
+};
+
+constexpr Tables MakeTables()
+{
+    Tables t{};
+    for(int i = 0; i < 256; ++i){
+        const AES::Byte s = S_Box[i >> 4][i & 15];
+        const AES::Byte v = Inv_S_Box[i >> 4][i & 15];
+        t.Sbox[i] = s;
+        t.InvSbox[i] = v;
+        const AES::Word e = AES::Word(GFMultiply(s, 0x02)) << 24 | AES::Word(s) << 16
+                | AES::Word(s) << 8 | GFMultiply(s, 0x03);
+        const AES::Word d = AES::Word(GFMultiply(v, 0x0e)) << 24 | AES::Word(GFMultiply(v, 0x09)) << 16
+                | AES::Word(GFMultiply(v, 0x0d)) << 8 | GFMultiply(v, 0x0b);
+        for(int j = 0; j < 4; ++j){
+            t.Te[j][i] = RotateRight(e, 8*j);
+            t.Td[j][i] = RotateRight(d, 8*j);
+        }
+    }
+    return t;
+}
+
+constexpr Tables tables = MakeTables();
+
+inline AES::Word SubWord(AES::Word w)
+{
+    return AES::Word(tables.Sbox[w >> 24]) << 24 | AES::Word(tables.Sbox[(w >> 16) & 0xff]) << 16
+            | AES::Word(tables.Sbox[(w >> 8) & 0xff]) << 8 | tables.Sbox[w & 0xff];
+}
+
+// 逆列混淆:先经S盒抵消Td中的逆S盒,只剩下乘法部分
+inline AES::Word MixColumnInv(AES::Word w)
+{
+    return tables.Td[0][tables.Sbox[w >> 24]] ^ tables.Td[1][tables.Sbox[(w >> 16) & 0xff]]
+            ^ tables.Td[2][tables.Sbox[(w >> 8) & 0xff]] ^ tables.Td[3][tables.Sbox[w & 0xff]];
+}
+
+// 分组的第c列组成一个字,第0行在最高字节
+inline void LoadColumns(const AES::Byte block[16], AES::Word s[4])
+{
+    for(int c = 0; c < 4; ++c)
+        s[c] = AES::Word(block[c]) << 24 | AES::Word(block[c+4]) << 16
+                | AES::Word(block[c+8]) << 8 | block[c+12];
+}
+
+inline void StoreColumns(const AES::Word s[4], AES::Byte block[16])
+{
+    for(int c = 0; c < 4; ++c){
+        block[c]    = static_cast<AES::Byte>(s[c] >> 24);
+        block[c+4]  = static_cast<AES::Byte>(s[c] >> 16);
+        block[c+8]  = static_cast<AES::Byte>(s[c] >> 8);
+        block[c+12] = static_cast<AES::Byte>(s[c]);
+    }
+}
+
+// 一轮加密:每列由4个T表查表结果与轮密钥异或得到,下标的错位即行移位
+#define AES_ENC_ROUND(t, s, k) \
+    t##0 = Te[0][s##0 >> 24] ^ Te[1][(s##1 >> 16) & 0xff] ^ Te[2][(s##2 >> 8) & 0xff] ^ Te[3][s##3 & 0xff] ^ (k)[0]; \
+    t##1 = Te[0][s##1 >> 24] ^ Te[1][(s##2 >> 16) & 0xff] ^ Te[2][(s##3 >> 8) & 0xff] ^ Te[3][s##0 & 0xff] ^ (k)[1]; \
+    t##2 = Te[0][s##2 >> 24] ^ Te[1][(s##3 >> 16) & 0xff] ^ Te[2][(s##0 >> 8) & 0xff] ^ Te[3][s##1 & 0xff] ^ (k)[2]; \
+    t##3 = Te[0][s##3 >> 24] ^ Te[1][(s##0 >> 16) & 0xff] ^ Te[2][(s##1 >> 8) & 0xff] ^ Te[3][s##2 & 0xff] ^ (k)[3]
+
+// 一轮解密,行移位方向与加密相反
+#define AES_DEC_ROUND(t, s, k) \
+    t##0 = Td[0][s##0 >> 24] ^ Td[1][(s##3 >> 16) & 0xff] ^ Td[2][(s##2 >> 8) & 0xff] ^ Td[3][s##1 & 0xff] ^ (k)[0]; \
+    t##1 = Td[0][s##1 >> 24] ^ Td[1][(s##0 >> 16) & 0xff] ^ Td[2][(s##3 >> 8) & 0xff] ^ Td[3][s##2 & 0xff] ^ (k)[1]; \
+    t##2 = Td[0][s##2 >> 24] ^ Td[1][(s##1 >> 16) & 0xff] ^ Td[2][(s##0 >> 8) & 0xff] ^ Td[3][s##3 & 0xff] ^ (k)[2]; \
+    t##3 = Td[0][s##3 >> 24] ^ Td[1][(s##2 >> 16) & 0xff] ^ Td[2][(s##1 >> 8) & 0xff] ^ Td[3][s##0 & 0xff] ^ (k)[3]
+
+// 最后一轮没有列混淆,直接查S盒
+inline AES::Word LastRound(const AES::Byte box[256], AES::Word a, AES::Word b, AES::Word c, AES::Word d)
+{
+    return AES::Word(box[a >> 24]) << 24 | AES::Word(box[(b >> 16) & 0xff]) << 16
+            | AES::Word(box[(c >> 8) & 0xff]) << 8 | box[d & 0xff];
+}
+
+/*
+ *  T表实现的单组加密:前9轮每列4次查表加轮密钥,两组状态交替使用,轮次完全展开
+ */
+void EncryptBlockTable(AES::Byte block[16], const AES::Word rk[44])
+{
+    const AES::Word (&Te)[4][256] = tables.Te;
+    AES::Word s[4], s0, s1, s2, s3, t0, t1, t2, t3;
+    LoadColumns(block, s);
+    s0 = s[0] ^ rk[0]; s1 = s[1] ^ rk[1]; s2 = s[2] ^ rk[2]; s3 = s[3] ^ rk[3];
+    AES_ENC_ROUND(t, s, rk+4);  AES_ENC_ROUND(s, t, rk+8);
+    AES_ENC_ROUND(t, s, rk+12); AES_ENC_ROUND(s, t, rk+16);
+    AES_ENC_ROUND(t, s, rk+20); AES_ENC_ROUND(s, t, rk+24);
+    AES_ENC_ROUND(t, s, rk+28); AES_ENC_ROUND(s, t, rk+32);
+    AES_ENC_ROUND(t, s, rk+36);
+    s[0] = LastRound(tables.Sbox, t0, t1, t2, t3) ^ rk[40];
+    s[1] = LastRound(tables.Sbox, t1, t2, t3, t0) ^ rk[41];
+    s[2] = LastRound(tables.Sbox, t2, t3, t0, t1) ^ rk[42];
+    s[3] = LastRound(tables.Sbox, t3, t0, t1, t2) ^ rk[43];
+    StoreColumns(s, block);
+}
+
+/*
+ *  T表实现的单组解密(等价逆密码),使用KeyExpansion生成的解密轮密钥
+ */
+void DecryptBlockTable(AES::Byte block[16], const AES::Word dk[44])
+{
+    const AES::Word (&Td)[4][256] = tables.Td;
+    AES::Word s[4], s0, s1, s2, s3, t0, t1, t2, t3;
+    LoadColumns(block, s);
+    s0 = s[0] ^ dk[0]; s1 = s[1] ^ dk[1]; s2 = s[2] ^ dk[2]; s3 = s[3] ^ dk[3];
+    AES_DEC_ROUND(t, s, dk+4);  AES_DEC_ROUND(s, t, dk+8);
+    AES_DEC_ROUND(t, s, dk+12); AES_DEC_ROUND(s, t, dk+16);
+    AES_DEC_ROUND(t, s, dk+20); AES_DEC_ROUND(s, t, dk+24);
+    AES_DEC_ROUND(t, s, dk+28); AES_DEC_ROUND(s, t, dk+32);
+    AES_DEC_ROUND(t, s, dk+36);
+    s[0] = LastRound(tables.InvSbox, t0, t3, t2, t1) ^ dk[40];
+    s[1] = LastRound(tables.InvSbox, t1, t0, t3, t2) ^ dk[41];
+    s[2] = LastRound(tables.InvSbox, t2, t1, t0, t3) ^ dk[42];
+    s[3] = LastRound(tables.InvSbox, t3, t2, t1, t0) ^ dk[43];
+    StoreColumns(s, block);
+}
+
+// 是否使用AES-NI,启动时由CPUID决定,自检失败时关闭
+bool useHardware = AES_NI::Available();
+}
+
 AES::AES()
     :Encryption() {}
 
@@ -36,494 +193,210 @@ QString AES::SetInitVec(const QString &target)
     return target;
 }
 
-QString AES::EncodeMessage(const QString &message)
+void AES::SetKeyBytes(const uint8_t *key)
 {
-    QString result;
+    std::copy(key, key+16, this->key);
+}
+
+void AES::SetInitVecBytes(const uint8_t *initVec)
+{
+    std::copy(initVec, initVec+16, keyInitVec);
+}
+
+bool AES::encrypt(const uint8_t *in, uint8_t *out, size_t len)
+{
+    if(mode != MODE::CTR && len%16 != 0)
+        return false;
+    PrepareKey();
+    const GroupCipher cipher = [this](uint8_t *groups, size_t count){ EncryGroups(groups, count); };
+    Byte chain[16];
+    std::copy(keyInitVec, keyInitVec+16, chain);
     switch(mode){
     case MODE::ECB:
-        result = EncodeECB(message);
+        ProcessECB(in, out, len/16, 16, cipher);
         break;
     case MODE::CBC:
-        result = EncodeCBC(message);
+        EncodeCBC(in, out, len/16, 16, chain, cipher);
+        break;
+    case MODE::CTR:
+        CryptCTR(in, out, len, 16, keyInitVec, cipher);
         break;
     }
-    return result;
+    return true;
 }
 
-QString AES::DecodeMessage(const QString &message)
+bool AES::decrypt(const uint8_t *in, uint8_t *out, size_t len)
 {
-    QString result;
+    if(mode != MODE::CTR && len%16 != 0)
+        return false;
+    PrepareKey();
+    const GroupCipher cipher = [this](uint8_t *groups, size_t count){ DecryGroups(groups, count); };
+    Byte chain[16];
+    std::copy(keyInitVec, keyInitVec+16, chain);
     switch(mode){
     case MODE::ECB:
-        result = DecodeECB(message);
+        ProcessECB(in, out, len/16, 16, cipher);
         break;
     case MODE::CBC:
-        result = DecodeCBC(message);
+        DecodeCBC(in, out, len/16, 16, chain, cipher);
+        break;
+    case MODE::CTR:    // CTR解密同样使用加密方向
+        CryptCTR(in, out, len, 16, keyInitVec,
+                 [this](uint8_t *groups, size_t count){ EncryGroups(groups, count); });
         break;
     }
-    return result;
-}
-
-QString AES::EncodeECB(const QString &message)
-{
-    QString result;
-    std::string record;
-    // 扩展密钥
-    KeyExpansion(key, expansionKey);
-    std::string text = message.toStdString();
-    int groups = text.length()/16;
-    Byte group[16];
-
-    for(auto x = 0;x < groups;++x){
-        // 转成byte数组
-        for(auto y = 0;y < 16;++y){
-            group[y] = Byte(text[x*16+y]);
-        }
-        // 加密
-        EncryPerGroup(group,expansionKey);
-        // 输出为16进制的形式
-        for(auto y = 0;y < 16;++y){
-            std::stringstream ioss;
-            std::string temp;
-            ioss << std::hex << group[y].to_ulong();
-            ioss >> temp;
-            record = record + temp + " ";
-        }
-    }
-    //对剩余不足的补'\0'
-    if(groups*16 < text.length()){
-        std::string substr = text.substr(groups*16);
-        substr += std::string(16-substr.size(),'\0');
-        // 转成byte数组
-        for(auto y = 0;y < 16;++y){
-            group[y] = Byte(substr[y]);
-        }
-        // 加密
-        EncryPerGroup(group,expansionKey);
-        // 输出为16进制的形式
-        for(auto y = 0;y < 16;++y){
-            std::stringstream ioss;
-            std::string temp;
-            ioss << std::hex << group[y].to_ulong();
-            ioss >> temp;
-            record = record + temp + " ";
-        }
-    }
-    result = QString::fromStdString(record);
-    result = result.toUpper();
-    return result;
-}
-
-QString AES::DecodeECB(const QString &message)
-{
-    QString result;
-    std::string record;
-    // 扩展密钥
-    KeyExpansion(key, expansionKey);
-
-    QStringList textList = message.split(" ");
-    Byte group[16];
-
-    for(auto x = 0;x < textList.size()-1;x += 16){
-        // 转成byte数组
-        for(auto y = 0;y < 16;++y){
-            const char* sC = textList.at(x+y).toStdString().c_str();
-            int num;
-            std::sscanf(sC, "%X", &num);
-            group[y] = Byte(num);
-        }
-        // 解密
-        DecryPerGroup(group,expansionKey);
-        // 输出为16进制的形式
-        for(auto y = 0;y < 16;++y){
-            record += this->BitsetToChar(group[y]);
-        }
-    }
-    result = QString::fromStdString(record);
-    return result;
+    return true;
 }
 
-QString AES::EncodeCBC(const QString &message)
+QString AES::EncodeMessage(const QString &message)
 {
-    QString result;
-    std::string record;
-    // 扩展密钥
-    KeyExpansion(key, expansionKey);
     std::string text = message.toStdString();
-    int groups = text.length()/16;
-    Byte group[16];
-
-    for(auto x = 0;x < groups;++x){
-        Byte cache_before;
-        // 转成byte数组
-        for(auto y = 0;y < 16;++y){
-            cache_before = group[y];
-            group[y] = Byte(text[x*16+y]);
-            if(x == 0) group[y] ^= keyInitVec[y];
-            else group[y] ^= cache_before;
-        }
-        // 加密
-        EncryPerGroup(group,expansionKey);
-        // 输出为16进制的形式
-        for(auto y = 0;y < 16;++y){
-            std::stringstream ioss;
-            std::string temp;
-            ioss << std::hex << group[y].to_ulong();
-            ioss >> temp;
-            record = record + temp + " ";
-        }
-    }
     //对剩余不足的补'\0'
-    if(groups*16 < text.length()){
-        std::string substr = text.substr(groups*16);
-        substr += std::string(16-substr.size(),'\0');
-        // 转成byte数组
-        for(auto y = 0;y < 16;++y){
-            Byte cache_before = group[y];
-            group[y] = Byte(substr[y]);
-            if(groups > 0) group[y] ^= cache_before;
-            else group[y] ^= keyInitVec[y];
-        }
-        // 加密
-        EncryPerGroup(group,expansionKey);
-        // 输出为16进制的形式
-        for(auto y = 0;y < 16;++y){
-            std::stringstream ioss;
-            std::string temp;
-            ioss << std::hex << group[y].to_ulong();
-            ioss >> temp;
-            record = record + temp + " ";
-        }
-    }
-    result = QString::fromStdString(record);
-    result = result.toUpper();
-    return result;
+    std::vector<Byte> data((text.length()+15)/16*16, 0);
+    std::copy(text.begin(), text.end(), data.begin());
+    encrypt(data.data(), data.data(), data.size());
+    // 输出为16进制的形式
+    return QString::fromStdString(BytesToHex(data.data(), data.size()));
 }
 
-QString AES::DecodeCBC(const QString &message)
+QString AES::DecodeMessage(const QString &message)
 {
-    QString result;
-    std::string record;
-    // 扩展密钥
-    KeyExpansion(key, expansionKey);
-    QStringList textList = message.split(" ");
-    Byte group[16];
-    Byte tmp_group[16];
-    Byte cache_before[16];
-
-    for(auto x = 0;x < textList.size()-1;x += 16){
-        // 转成byte数组
-        for(auto y = 0;y < 16;++y){
-            const char* sC = textList.at(x+y).toStdString().c_str();
-            int num;
-            std::sscanf(sC, "%X", &num);
-            cache_before[y] = group[y];
-            group[y] = Byte(num);
-            tmp_group[y] = group[y];
-        }
-        // 解密
-        DecryPerGroup(tmp_group,expansionKey);
-        // 输出为16进制的形式
-        for(auto y = 0;y < 16;++y){
-            if(x == 0)tmp_group[y] ^= keyInitVec[y];
-            else tmp_group[y] ^= cache_before[y];
-            record += this->BitsetToChar(tmp_group[y]);
-        }
-    }
-    result = QString::fromStdString(record);
-    return result;
+    std::vector<Byte> data = HexToBytes(message);
+    data.resize(data.size()/16*16);
+    decrypt(data.data(), data.data(), data.size());
+    return QString::fromStdString(std::string(data.begin(), data.end()));
 }
 
-void AES::EncryPerGroup(AES::Byte target[16], AES::Word expansionKey[44]){
-    Word keyt[4];
-    // 密钥扩展
-    for(int i=0; i<4; ++i)
-        keyt[i] = expansionKey[i];
-    // 轮密钥加
-    KeyRoundAdd(target,keyt);
-
-    // 字节代替、行以为、列混淆、轮密钥加
-    for(int round=1; round< 10; ++round){
-        MapToSboxMtx(target);
-        RowsShift(target);
-        ColumnsMix(target);
-        for(int i=0; i<4; ++i)
-            keyt[i] = expansionKey[4*round+i];
-        KeyRoundAdd(target, keyt);
-    }
-    // 字节代替、行移位、轮密钥加
-    MapToSboxMtx(target);
-    RowsShift(target);
-    for(int i=0; i<4; ++i)
-        keyt[i] = expansionKey[40+i];
-    KeyRoundAdd(target, keyt);
-}
-
-void AES::DecryPerGroup(AES::Byte target[16], AES::Word expansionKey[44]){
-    Word keyt[4];
-    // 密钥扩展
-    for(int i=0; i<4; ++i)
-        keyt[i] = expansionKey[40+i];
-    // 轮密钥加
-    KeyRoundAdd(target, keyt);
-    // 与加密相反的顺序
-    for(int round=9; round > 0; --round){
-        RowsShiftInv(target);
-        MapToSboxMtxInv(target);
-        for(int i=0; i<4; ++i)
-            keyt[i] = expansionKey[4*round+i];
-        KeyRoundAdd(target, keyt);
-        ColumnsMixInv(target);
-    }
-    // last round, DO NOT have InvMixCol
-    RowsShiftInv(target);
-    MapToSboxMtxInv(target);
-    for(int i=0; i<4; ++i)
-        keyt[i] = expansionKey[i];
-    KeyRoundAdd(target, keyt);
-}
-
-std::string AES::BitsetToChar(const AES::Byte &target)
+void AES::EncryGroups(AES::Byte *groups, size_t count)
 {
-    std::string result;
-    result.push_back(static_cast<char>(target.to_ulong()));
-    return result;
+    if(useHardware)
+        AES_NI::EncryptBlocks(groups, count, roundKeyNI);
+    else
+        for(size_t x = 0; x < count; ++x)
+            EncryptBlockTable(groups+16*x, expansionKey);
 }
 
-AES::Word AES::ByteToWord(AES::Byte &k1, AES::Byte &k2,
-                          AES::Byte &k3, AES::Byte &k4)
+void AES::DecryGroups(AES::Byte *groups, size_t count)
 {
-    //将四个字节压成一个字
-    Word result(0x00000000);
-    Word temp;
-
-    temp = k1.to_ulong();
-    temp <<= 24;
-    result |= temp;
-
-    temp = k2.to_ulong();
-    temp <<= 16;
-    result |= temp;
-
-    temp = k3.to_ulong();
-    temp <<= 8;
-    result |= temp;
-
-    temp = k4.to_ulong();
-    result |= temp;
-    return result;
+    if(useHardware)
+        AES_NI::DecryptBlocks(groups, count, roundKeyInvNI);
+    else
+        for(size_t x = 0; x < count; ++x)
+            DecryptBlockTable(groups+16*x, decryptionKey);
 }
 
-AES::Word AES::LeftShift(const AES::Word &target)
+std::string AES::BytesToHex(const AES::Byte *data, size_t length)
 {
-    /**
-     *  按字节 循环左移一位
-     *  即把[a0, a1, a2, a3]变成[a1, a2, a3, a0]
-     */
-    Word high = target << 8;
-    Word low  = target >> 24;
-    return high | low;
-}
-
-AES::Word AES::MapToSboxKey(const AES::Word &target){
-    /**
-     *  对输入word中的每一个字节进行S-盒映射
-     */
-    Word ret;
-    for(int i = 0; i < 32; i+=8){
-        int row = target[i+7]*8 + target[i+6]*4
-                + target[i+5]*2 + target[i+4];
-        int col = target[i+3]*8 + target[i+2]*4
-                + target[i+1]*2 + target[i];
-        Byte val = AES_Operation::S_Box[row][col];
-        for(int j=0; j<8; ++j)
-            ret[i+j] = val[j];
+    static const char digits[] = "0123456789ABCDEF";
+    std::string record;
+    record.reserve(length*3);
+    for(size_t i = 0; i < length; ++i){
+        if(data[i] >= 16)
+            record.push_back(digits[data[i] >> 4]);
+        record.push_back(digits[data[i] & 15]);
+        record.push_back(' ');
     }
-    return ret;
+    return record;
 }
 
-void AES::KeyExpansion(AES::Byte key[16], AES::Word w[44]){
-    /**
-     *  密钥扩展函数 - 对128位密钥进行扩展得到 w[44]
-     */
-    Word temp;
-    int index = 0;
-    // w[]的前4个就是输入的key
-    while(index < 4){
-        w[index] = ByteToWord(key[4*index], key[4*index+1],
-                key[4*index+2], key[4*index+3]);
-        ++index;
-    }
-
-    index = 4;
-
-    while(index < 44){
-        temp = w[index-1]; // 记录前一个word
-        if(index % 4 == 0){
-            Word tmp2 = LeftShift(temp);
-            w[index] = w[index-4] ^
-                    MapToSboxKey(tmp2) ^
-                    AES_Operation::Rcon[index/4-1];
+std::vector<AES::Byte> AES::HexToBytes(const QString &message)
+{
+    std::vector<Byte> data;
+    const std::string text = message.toStdString();
+    const char *p = text.c_str();
+    while(*p){
+        char *next;
+        const unsigned long num = std::strtoul(p, &next, 16);
+        if(next == p){    // 跳过不能解析的字符
+            ++p;
+            continue;
         }
-        else
-            w[index] = w[index-4] ^ temp;
-        ++index;
+        data.push_back(static_cast<Byte>(num));
+        p = next;
     }
+    return data;
 }
 
-void AES::MapToSboxMtx(AES::Byte mtx[16])
+bool AES::SelfTest()
 {
-    /*
-     *  S盒变换 - 前4位为行号，后4位为列号
-     */
-    for(int i=0; i<16; ++i){
-        int row = mtx[i][7]*8 + mtx[i][6]*4 + mtx[i][5]*2 + mtx[i][4];
-        int col = mtx[i][3]*8 + mtx[i][2]*4 + mtx[i][1]*2 + mtx[i][0];
-        mtx[i] = AES_Operation::S_Box[row][col];
-    }
-}
-
-void AES::RowsShift(AES::Byte mtx[16]){
-    /*
-     *  行移位 - 按字节循环移位,第一行不变
-     */
-    // 第二行循环左移一位
-    Byte temp = mtx[4];
-    for(int i=0; i<3; ++i)
-        mtx[i+4] = mtx[i+5];
-    mtx[7] = temp;
-
-    // 第三行循环左移两位
-    for(int i=0; i<2; ++i){
-        temp = mtx[i+8];
-        mtx[i+8] = mtx[i+10];
-        mtx[i+10] = temp;
-    }
-
-    // 第四行循环左移三位
-    temp = mtx[15];
-    for(int i=3; i>0; --i)
-        mtx[i+12] = mtx[i+11];
-    mtx[12] = temp;
-}
-
-AES::Byte AES::GFMultiply(AES::Byte a, AES::Byte b){
-    /*
-     *  有限域上的乘法和加法 GF(2^8)
-     */
-    Byte ret = 0;
-    Byte hi_bit_set;
-    for (int counter = 0; counter < 8; ++counter) {
-        if ((b & Byte(1)) != 0) {
-            ret ^= a;
-        }
-        hi_bit_set = static_cast<Byte>(a & Byte(0x80));
-        a <<= 1;
-        if (hi_bit_set != 0) {
-            a ^= 0x1b; /* x^8 + x^4 + x^3 + x + 1 */
+    // FIPS-197附录B与附录C.1,明文和密文按标准的列序给出
+    static const Byte vectors[2][3][16] = {
+        {{0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c},
+         {0x32, 0x43, 0xf6, 0xa8, 0x88, 0x5a, 0x30, 0x8d, 0x31, 0x31, 0x98, 0xa2, 0xe0, 0x37, 0x07, 0x34},
+         {0x39, 0x25, 0x84, 0x1d, 0x02, 0xdc, 0x09, 0xfb, 0xdc, 0x11, 0x85, 0x97, 0x19, 0x6a, 0x0b, 0x32}},
+        {{0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f},
+         {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff},
+         {0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a}}
+    };
+    bool tableOk = true, hardwareOk = true;
+    for(const auto &v : vectors){
+        Byte plain[16], cipher[16], block[16];
+        // 转成按行存放
+        for(int i = 0; i < 16; ++i){
+            plain[(i%4)*4+i/4] = v[1][i];
+            cipher[(i%4)*4+i/4] = v[2][i];
         }
-        b >>= 1;
+        Word w[44], dw[44];
+        KeyExpansion(v[0], w, dw);
+        std::copy(plain, plain+16, block);
+        EncryptBlockTable(block, w);
+        tableOk = tableOk && std::equal(block, block+16, cipher);
+        DecryptBlockTable(block, dw);
+        tableOk = tableOk && std::equal(block, block+16, plain);
+
+        if(!useHardware)
+            continue;
+        uint8_t enc[176], dec[176];
+        AES_NI::KeyExpansion(v[0], enc, dec);
+        for(int i = 0; i < 44; ++i)    // 两种密钥扩展的结果应当一致
+            hardwareOk = hardwareOk && enc[4*i] == Byte(w[i] >> 24) && enc[4*i+1] == Byte(w[i] >> 16)
+                    && enc[4*i+2] == Byte(w[i] >> 8) && enc[4*i+3] == Byte(w[i]);
+        std::copy(plain, plain+16, block);
+        AES_NI::EncryptBlock(block, enc);
+        hardwareOk = hardwareOk && std::equal(block, block+16, cipher);
+        AES_NI::DecryptBlock(block, dec);
+        hardwareOk = hardwareOk && std::equal(block, block+16, plain);
     }
-    return ret;
-}
-
-void AES::ColumnsMix(AES::Byte mtx[]){
-    /*
-     *  列混淆，矩阵乘法
-     */
-    Byte arr[4];
-    for(int i=0; i<4; ++i){
-        for(int j=0; j<4; ++j)
-            arr[j] = mtx[i+j*4];
-
-        mtx[i]   = GFMultiply(0x02, arr[0]) ^
-                GFMultiply(0x03, arr[1]) ^ arr[2] ^ arr[3];
-        mtx[i+4] = arr[0] ^
-                GFMultiply(0x02, arr[1]) ^
-                GFMultiply(0x03, arr[2]) ^ arr[3];
-        mtx[i+8] = arr[0] ^ arr[1] ^
-                GFMultiply(0x02, arr[2]) ^
-                GFMultiply(0x03, arr[3]);
-        mtx[i+12] = GFMultiply(0x03, arr[0]) ^
-                arr[1] ^ arr[2] ^ GFMultiply(0x02, arr[3]);
+    if(!hardwareOk){
+        qWarning("AES-NI self-test failed, falling back to table implementation");
+        useHardware = false;
     }
+    return tableOk;
 }
 
-void AES::KeyRoundAdd(AES::Byte mtx[16], AES::Word k[4]){
-    /*
-     *  轮密钥加变换 - 将每一列与扩展密钥进行异或
-     */
-    for(int i=0; i<4; ++i){
-        // 获取字的四个字节
-        Word k1 = (k[i] >> 24);
-        Word k2 = (k[i] <<  8) >> 24;
-        Word k3 = (k[i] << 16) >> 24;
-        Word k4 = (k[i] << 24) >> 24;
-
-        mtx[i]    = mtx[i]    ^ Byte(k1.to_ulong());
-        mtx[i+4]  = mtx[i+4]  ^ Byte(k2.to_ulong());
-        mtx[i+8]  = mtx[i+8]  ^ Byte(k3.to_ulong());
-        mtx[i+12] = mtx[i+12] ^ Byte(k4.to_ulong());
-    }
+bool AES::HardwareAccelerated()
+{
+    return useHardware;
 }
 
-void AES::RowsShiftInv(AES::Byte mtx[16]){
-    /*
-     *  逆行变换 - 以字节为单位循环右移
-     */
-    // 第二行循环右移一位
-    Byte temp = mtx[7];
-    for(int i=3; i>0; --i)
-        mtx[i+4] = mtx[i+3];
-    mtx[4] = temp;
-    // 第三行循环右移两位
-    for(int i=0; i<2; ++i){
-        temp = mtx[i+8];
-        mtx[i+8] = mtx[i+10];
-        mtx[i+10] = temp;
-    }
-    // 第四行循环右移三位
-    temp = mtx[12];
-    for(int i=0; i<3; ++i)
-        mtx[i+12] = mtx[i+13];
-    mtx[15] = temp;
+void AES::PrepareKey()
+{
+    if(useHardware)
+        AES_NI::KeyExpansion(key, roundKeyNI, roundKeyInvNI);
+    else
+        KeyExpansion(key, expansionKey, decryptionKey);
 }
 
-void AES::MapToSboxMtxInv(AES::Byte mtx[16]){
-    /*
-     *  逆S盒变换
+void AES::KeyExpansion(const AES::Byte key[16], AES::Word w[44], AES::Word dw[44]){
+    /**
+     *  密钥扩展函数 - 对128位密钥进行扩展得到 w[44],
+     *  同时生成解密用的 dw[44]:轮密钥逆序,第1~9轮做逆列混淆
      */
-    for(int i=0; i<16; ++i){
-        int row = mtx[i][7]*8 + mtx[i][6]*4 + mtx[i][5]*2 + mtx[i][4];
-        int col = mtx[i][3]*8 + mtx[i][2]*4 + mtx[i][1]*2 + mtx[i][0];
-        mtx[i] = AES_Operation::Inv_S_Box[row][col];
+    // w[]的前4个就是输入的key
+    for(int index = 0; index < 4; ++index)
+        w[index] = Word(key[4*index]) << 24 | Word(key[4*index+1]) << 16
+                | Word(key[4*index+2]) << 8 | key[4*index+3];
+
+    for(int index = 4; index < 44; ++index){
+        Word temp = w[index-1]; // 记录前一个word
+        if(index % 4 == 0)  // 按字节循环左移一位后做S盒映射,再加轮常数
+            temp = SubWord((temp << 8) | (temp >> 24)) ^ AES_Operation::Rcon[index/4-1];
+        w[index] = w[index-4] ^ temp;
     }
-}
 
-void AES::ColumnsMixInv(AES::Byte mtx[]){
-    /*
-     * 逆向列混淆
-     */
-    Byte arr[4];
-    for(int i=0; i<4; ++i){
-        for(int j=0; j<4; ++j)
-            arr[j] = mtx[i+j*4];
-
-        mtx[i]    = GFMultiply(0x0e, arr[0]) ^
-                GFMultiply(0x0b, arr[1]) ^
-                GFMultiply(0x0d, arr[2]) ^
-                GFMultiply(0x09, arr[3]);
-        mtx[i+4]  = GFMultiply(0x09, arr[0]) ^
-                GFMultiply(0x0e, arr[1]) ^
-                GFMultiply(0x0b, arr[2]) ^
-                GFMultiply(0x0d, arr[3]);
-        mtx[i+8]  = GFMultiply(0x0d, arr[0]) ^
-                GFMultiply(0x09, arr[1]) ^
-                GFMultiply(0x0e, arr[2]) ^
-                GFMultiply(0x0b, arr[3]);
-        mtx[i+12] = GFMultiply(0x0b, arr[0]) ^
-                GFMultiply(0x0d, arr[1]) ^
-                GFMultiply(0x09, arr[2]) ^
-                GFMultiply(0x0e, arr[3]);
-    }
+    for(int round = 0; round <= 10; ++round)
+        for(int i = 0; i < 4; ++i){
+            Word k = w[4*(10-round)+i];
+            dw[4*round+i] = (round == 0 || round == 10) ? k : MixColumnInv(k);
+        }
 }
@@ -1,61 +1,60 @@
 #ifndef AES_H
 #define AES_H
 #include "Encryption.h"
+#include <cstdint>
+#include <string>
+#include <vector>
 
 class AES : public Encryption
 {
 public:
-    typedef std::bitset<8> Byte; //一个字节
-    typedef std::bitset<32> Word;//一个字
+    typedef uint8_t Byte; //一个字节
+    typedef uint32_t Word;//一个字,高位字节在前
 
     AES();
     virtual ~AES();
 
     virtual QString SetKey(const QString &key);
     virtual QString SetInitVec(const QString &target);
+    virtual void SetKeyBytes(const uint8_t *key);    // 16字节,标准字节序
+    virtual void SetInitVecBytes(const uint8_t *initVec);    // 16字节,与数据一样按行存放
+    virtual bool encrypt(const uint8_t *in, uint8_t *out, size_t len);
+    virtual bool decrypt(const uint8_t *in, uint8_t *out, size_t len);
+    // 密文格式:每个字节为不补0的大写十六进制,以空格分隔
     virtual QString EncodeMessage(const QString &message);
     virtual QString DecodeMessage(const QString &message);
 
+    // 用FIPS-197附录B、C.1的向量检查查表实现和AES-NI实现,AES-NI出错时退回查表实现;
+    // 查表实现出错时返回false。程序启动时调用一次
+    static bool SelfTest();
+    static bool HardwareAccelerated();    // 当前是否使用AES-NI
+
 private:
     Byte key[16];
     Byte keyInitVec[16];
     Word expansionKey[44];
-
-    /* -------------------两种模式---------------- */
-    QString EncodeECB(const QString &message);
-    QString DecodeECB(const QString &message);
-    QString EncodeCBC(const QString &message);
-    QString DecodeCBC(const QString &message);
+    Word decryptionKey[44];    // 等价逆密码使用的轮密钥:逆序排列,中间各轮做过逆列混淆
+    uint8_t roundKeyNI[176];    // AES-NI使用的加密轮密钥,标准字节序
+    uint8_t roundKeyInvNI[176];    // AES-NI使用的解密轮密钥
 
     /*-------------密钥扩展操作-----------------*/
-    Word ByteToWord(Byte &k1,Byte &k2,Byte &k3,Byte &k4);
-    Word LeftShift(const Word &target);
-    Word MapToSboxKey(const Word &target);
-    void KeyExpansion(Byte key[16], Word w[44]);
-
-    /*-------------加密正向变换-----------------*/
-    void MapToSboxMtx(Byte mtx[16]);
-    void RowsShift(Byte mtx[16]);
-    Byte GFMultiply(Byte a, Byte b);
-    void ColumnsMix(Byte mtx[16]);
-    void KeyRoundAdd(Byte mtx[16], Word k[4]);
-
-    /*-------------解密正向变换-----------------*/
-    void RowsShiftInv(Byte mtx[16]);
-    void MapToSboxMtxInv(Byte mtx[16]);
-    void ColumnsMixInv(Byte mtx[16]);
-
+    static void KeyExpansion(const Byte key[16], Word w[44], Word dw[44]);
+    void PrepareKey();    // 为当前使用的实现扩展密钥
 
     /*-------------逐组加密/解密---------------*/
-    void EncryPerGroup(Byte target[16],Word expansionKey[44]);
-    void DecryPerGroup(Byte target[16],Word expansionKey[43]);
-    std::string BitsetToChar(const Byte &target);
+    // 状态矩阵按行存放:target[row*4+col]为第row行第col列,按CPU支持情况选择AES-NI或查表实现
+    void EncryGroups(Byte *groups, size_t count);    // 连续多组原地加密,AES-NI下多组交错执行
+    void DecryGroups(Byte *groups, size_t count);    // 连续多组原地解密
+
+    /*-------------文本格式---------------*/
+    static std::string BytesToHex(const Byte *data, size_t length);
+    static std::vector<Byte> HexToBytes(const QString &message);    // 解析时忽略多余的空格
 };
 
 namespace AES_Operation{
 
 /*-----------------------S盒--------------------*/
-const AES::Byte S_Box[16][16] = {
+constexpr AES::Byte S_Box[16][16] = {
     {0x63, 0x7C, 0x77, 0x7B, 0xF2, 0x6B, 0x6F, 0xC5, 0x30, 0x01, 0x67, 0x2B, 0xFE, 0xD7, 0xAB, 0x76},
     {0xCA, 0x82, 0xC9, 0x7D, 0xFA, 0x59, 0x47, 0xF0, 0xAD, 0xD4, 0xA2, 0xAF, 0x9C, 0xA4, 0x72, 0xC0},
     {0xB7, 0xFD, 0x93, 0x26, 0x36, 0x3F, 0xF7, 0xCC, 0x34, 0xA5, 0xE5, 0xF1, 0x71, 0xD8, 0x31, 0x15},
@@ -73,7 +72,7 @@ const AES::Byte S_Box[16][16] = {
     {0xE1, 0xF8, 0x98, 0x11, 0x69, 0xD9, 0x8E, 0x94, 0x9B, 0x1E, 0x87, 0xE9, 0xCE, 0x55, 0x28, 0xDF},
     {0x8C, 0xA1, 0x89, 0x0D, 0xBF, 0xE6, 0x42, 0x68, 0x41, 0x99, 0x2D, 0x0F, 0xB0, 0x54, 0xBB, 0x16}
 };
-const AES::Byte Inv_S_Box[16][16] = {
+constexpr AES::Byte Inv_S_Box[16][16] = {
     {0x52, 0x09, 0x6A, 0xD5, 0x30, 0x36, 0xA5, 0x38, 0xBF, 0x40, 0xA3, 0x9E, 0x81, 0xF3, 0xD7, 0xFB},
     {0x7C, 0xE3, 0x39, 0x82, 0x9B, 0x2F, 0xFF, 0x87, 0x34, 0x8E, 0x43, 0x44, 0xC4, 0xDE, 0xE9, 0xCB},
     {0x54, 0x7B, 0x94, 0x32, 0xA6, 0xC2, 0x23, 0x3D, 0xEE, 0x4C, 0x95, 0x0B, 0x42, 0xFA, 0xC3, 0x4E},
@@ -93,7 +92,7 @@ const AES::Byte Inv_S_Box[16][16] = {
 };
 
 // 轮常数，密钥扩展中用到。（AES-128只需要10轮）
-const AES::Word Rcon[10] = {0x01000000, 0x02000000, 0x04000000, 0x08000000, 0x10000000,
+constexpr AES::Word Rcon[10] = {0x01000000, 0x02000000, 0x04000000, 0x08000000, 0x10000000,
                       0x20000000, 0x40000000, 0x80000000, 0x1b000000, 0x36000000};
 
 }
@@ -0,0 +1,161 @@
+#include "AES_NI.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define AES_NI_TARGET
+#else
+#include <cpuid.h>
+// 只给本文件中的函数打开AES与SSSE3指令,其他代码仍按默认指令集编译
+#define AES_NI_TARGET __attribute__((target("aes,ssse3")))
+#endif
+
+namespace {
+
+// 按行存放与按列存放互相转换的字节重排,4x4转置是自身的逆
+AES_NI_TARGET inline __m128i Transpose(__m128i block)
+{
+    return _mm_shuffle_epi8(block, _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15));
+}
+
+// 由上一轮密钥和aeskeygenassist的结果得到下一轮密钥
+AES_NI_TARGET inline __m128i ExpandStep(__m128i key, __m128i assist)
+{
+    assist = _mm_shuffle_epi32(assist, 0xff);
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    return _mm_xor_si128(key, assist);
+}
+
+}
+
+namespace AES_NI {
+
+bool Available()
+{
+    unsigned int ecx = 0;
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    ecx = static_cast<unsigned int>(info[2]);
+#else
+    unsigned int eax, ebx, edx;
+    if(!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+#endif
+    const unsigned int ssse3 = 1u << 9, aes = 1u << 25;
+    return (ecx & ssse3) && (ecx & aes);
+}
+
+AES_NI_TARGET void KeyExpansion(const uint8_t key[16], uint8_t enc[176], uint8_t dec[176])
+{
+    __m128i k[11];
+    k[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key));
+    // aeskeygenassist的轮常数必须是立即数
+    k[1]  = ExpandStep(k[0], _mm_aeskeygenassist_si128(k[0], 0x01));
+    k[2]  = ExpandStep(k[1], _mm_aeskeygenassist_si128(k[1], 0x02));
+    k[3]  = ExpandStep(k[2], _mm_aeskeygenassist_si128(k[2], 0x04));
+    k[4]  = ExpandStep(k[3], _mm_aeskeygenassist_si128(k[3], 0x08));
+    k[5]  = ExpandStep(k[4], _mm_aeskeygenassist_si128(k[4], 0x10));
+    k[6]  = ExpandStep(k[5], _mm_aeskeygenassist_si128(k[5], 0x20));
+    k[7]  = ExpandStep(k[6], _mm_aeskeygenassist_si128(k[6], 0x40));
+    k[8]  = ExpandStep(k[7], _mm_aeskeygenassist_si128(k[7], 0x80));
+    k[9]  = ExpandStep(k[8], _mm_aeskeygenassist_si128(k[8], 0x1b));
+    k[10] = ExpandStep(k[9], _mm_aeskeygenassist_si128(k[9], 0x36));
+    for(int i = 0; i <= 10; ++i){
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(enc+16*i), k[i]);
+        const __m128i d = (i == 0 || i == 10) ? k[10-i] : _mm_aesimc_si128(k[10-i]);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dec+16*i), d);
+    }
+}
+
+AES_NI_TARGET void EncryptBlock(uint8_t block[16], const uint8_t enc[176])
+{
+    const __m128i *rk = reinterpret_cast<const __m128i*>(enc);
+    __m128i s = Transpose(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block)));
+    s = _mm_xor_si128(s, _mm_loadu_si128(rk));
+    for(int round = 1; round < 10; ++round)
+        s = _mm_aesenc_si128(s, _mm_loadu_si128(rk+round));
+    s = _mm_aesenclast_si128(s, _mm_loadu_si128(rk+10));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(block), Transpose(s));
+}
+
+AES_NI_TARGET void DecryptBlock(uint8_t block[16], const uint8_t dec[176])
+{
+    const __m128i *rk = reinterpret_cast<const __m128i*>(dec);
+    __m128i s = Transpose(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block)));
+    s = _mm_xor_si128(s, _mm_loadu_si128(rk));
+    for(int round = 1; round < 10; ++round)
+        s = _mm_aesdec_si128(s, _mm_loadu_si128(rk+round));
+    s = _mm_aesdeclast_si128(s, _mm_loadu_si128(rk+10));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(block), Transpose(s));
+}
+
+// 8组交错:对每一组各做一次同样的操作,展开后各组状态都留在寄存器中
+#define AES_NI_LANES(op) op(0) op(1) op(2) op(3) op(4) op(5) op(6) op(7)
+#define AES_NI_LOAD(i) __m128i s##i = _mm_xor_si128(Transpose(_mm_loadu_si128(data+x+i)), k);
+#define AES_NI_ENC(i) s##i = _mm_aesenc_si128(s##i, k);
+#define AES_NI_ENC_LAST(i) _mm_storeu_si128(data+x+i, Transpose(_mm_aesenclast_si128(s##i, k)));
+#define AES_NI_DEC(i) s##i = _mm_aesdec_si128(s##i, k);
+#define AES_NI_DEC_LAST(i) _mm_storeu_si128(data+x+i, Transpose(_mm_aesdeclast_si128(s##i, k)));
+
+AES_NI_TARGET void EncryptBlocks(uint8_t *blocks, size_t count, const uint8_t enc[176])
+{
+    const __m128i *rk = reinterpret_cast<const __m128i*>(enc);
+    __m128i *data = reinterpret_cast<__m128i*>(blocks);
+    size_t x = 0;
+    for(; x+8 <= count; x += 8){
+        __m128i k = _mm_loadu_si128(rk);
+        AES_NI_LANES(AES_NI_LOAD)
+        for(int round = 1; round < 10; ++round){
+            k = _mm_loadu_si128(rk+round);
+            AES_NI_LANES(AES_NI_ENC)
+        }
+        k = _mm_loadu_si128(rk+10);
+        AES_NI_LANES(AES_NI_ENC_LAST)
+    }
+    for(; x < count; ++x)
+        EncryptBlock(blocks+16*x, enc);
+}
+
+AES_NI_TARGET void DecryptBlocks(uint8_t *blocks, size_t count, const uint8_t dec[176])
+{
+    const __m128i *rk = reinterpret_cast<const __m128i*>(dec);
+    __m128i *data = reinterpret_cast<__m128i*>(blocks);
+    size_t x = 0;
+    for(; x+8 <= count; x += 8){
+        __m128i k = _mm_loadu_si128(rk);
+        AES_NI_LANES(AES_NI_LOAD)
+        for(int round = 1; round < 10; ++round){
+            k = _mm_loadu_si128(rk+round);
+            AES_NI_LANES(AES_NI_DEC)
+        }
+        k = _mm_loadu_si128(rk+10);
+        AES_NI_LANES(AES_NI_DEC_LAST)
+    }
+    for(; x < count; ++x)
+        DecryptBlock(blocks+16*x, dec);
+}
+
+}
+
+#else
+
+namespace AES_NI {
+
+bool Available()
+{
+    return false;
+}
+
+void KeyExpansion(const uint8_t *, uint8_t *, uint8_t *) {}
+void EncryptBlock(uint8_t *, const uint8_t *) {}
+void DecryptBlock(uint8_t *, const uint8_t *) {}
+void EncryptBlocks(uint8_t *, size_t, const uint8_t *) {}
+void DecryptBlocks(uint8_t *, size_t, const uint8_t *) {}
+
+}
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef AES_NI_H
+#define AES_NI_H
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * 基于AES-NI指令的AES-128实现,只在运行时通过CPUID确认处理器支持后使用。
+ * 分组与AES类相同,按行存放(block[row*4+col]),进出时用一次字节重排转换为指令要求的列序。
+ * 不是x86平台或编译器不支持时Available()恒为false
+ */
+namespace AES_NI {
+
+// 处理器是否支持AES-NI与SSSE3
+bool Available();
+
+// 用aeskeygenassist扩展密钥,enc为11个加密轮密钥,dec为对应的解密轮密钥(逆序并做过aesimc)
+void KeyExpansion(const uint8_t key[16], uint8_t enc[176], uint8_t dec[176]);
+
+// 单组加密/解密,原地进行
+void EncryptBlock(uint8_t block[16], const uint8_t enc[176]);
+void DecryptBlock(uint8_t block[16], const uint8_t dec[176]);
+
+// 连续count个分组原地加密,每次8组交错执行,让多个aesenc同时在流水线中
+void EncryptBlocks(uint8_t *blocks, size_t count, const uint8_t enc[176]);
+void DecryptBlocks(uint8_t *blocks, size_t count, const uint8_t dec[176]);
+
+}
+
+#endif // AES_NI_H
@@ -1,38 +1,97 @@
 #include "Des.h"
 #include <QDebug>
-#include <iostream>
+#include <algorithm>
+#include <vector>
 
 Des::Des()
     :Encryption() {}
 
 Des::~Des() {}
 
-QString Des::EncodeMessage(const QString &message)
+bool Des::encrypt(const uint8_t *in, uint8_t *out, size_t len)
 {
-    QString result;
+    if(this->mode != MODE::CTR && len%8 != 0)
+        return false;
+    subkey = GenerateCiphers(key);
+    const GroupCipher cipher = [this](uint8_t *groups, size_t count){
+        for(size_t x = 0; x < count; ++x)
+            BitsetToBytes(EncryPerGroup(BytesToBitset(groups+8*x)), groups+8*x);
+    };
+    uint8_t chain[8];
+    BitsetToBytes(keyInitVec, chain);
     switch(this->mode){
     case MODE::ECB:
-        result = EncodeECB(message);
+        ProcessECB(in, out, len/8, 8, cipher);
         break;
     case MODE::CBC:
-        result = EncodeCBC(message);
+        EncodeCBC(in, out, len/8, 8, chain, cipher);
+        break;
+    case MODE::CTR:
+        CryptCTR(in, out, len, 8, chain, cipher);
         break;
     }
-    return result;
+    return true;
 }
 
-QString Des::DecodeMessage(const QString &message)
+bool Des::decrypt(const uint8_t *in, uint8_t *out, size_t len)
 {
-    QString result;
+    if(this->mode != MODE::CTR && len%8 != 0)
+        return false;
+    subkey = GenerateCiphers(key);
+    const GroupCipher cipher = [this](uint8_t *groups, size_t count){
+        for(size_t x = 0; x < count; ++x)
+            BitsetToBytes(DecryPerGroup(BytesToBitset(groups+8*x)), groups+8*x);
+    };
+    uint8_t chain[8];
+    BitsetToBytes(keyInitVec, chain);
     switch(this->mode){
     case MODE::ECB:
-        result = DecodeECB(message);
+        ProcessECB(in, out, len/8, 8, cipher);
         break;
     case MODE::CBC:
-        result = DecodeCBC(message);
+        DecodeCBC(in, out, len/8, 8, chain, cipher);
+        break;
+    case MODE::CTR:    // CTR解密同样使用加密方向
+        CryptCTR(in, out, len, 8, chain, [this](uint8_t *groups, size_t count){
+            for(size_t x = 0; x < count; ++x)
+                BitsetToBytes(EncryPerGroup(BytesToBitset(groups+8*x)), groups+8*x);
+        });
         break;
     }
-    return result;
+    return true;
+}
+
+QString Des::EncodeMessage(const QString &message)
+{
+    std::string text = message.toStdString();
+    // 对剩余的不足64进行补'\0'
+    std::vector<uint8_t> data((text.size()+7)/8*8, 0);
+    std::copy(text.begin(), text.end(), data.begin());
+    encrypt(data.data(), data.data(), data.size());
+    // 界面上CBC模式的初始向量随加密推进,下一次加密接着最后一组密文继续
+    if(this->mode == MODE::CBC && !data.empty())
+        keyInitVec = BytesToBitset(data.data()+data.size()-8);
+    // 每组输出为64个'0'/'1'
+    std::string record;
+    record.reserve(data.size()*8);
+    for(size_t x = 0; x < data.size(); x += 8)
+        record += BytesToBitset(data.data()+x).to_string();
+    return QString::fromStdString(record);
+}
+
+QString Des::DecodeMessage(const QString &message)
+{
+    std::string text = message.toStdString();
+    std::vector<uint8_t> data(text.size()/64*8);
+    for(size_t x = 0; x < data.size()/8; ++x)
+        BitsetToBytes(std::bitset<64>(text.substr(x*64,64)), data.data()+8*x);
+    std::bitset<64> last = keyInitVec;
+    if(!data.empty())
+        last = BytesToBitset(data.data()+data.size()-8);
+    decrypt(data.data(), data.data(), data.size());
+    if(this->mode == MODE::CBC)
+        keyInitVec = last;
+    return QString::fromStdString(std::string(data.begin(), data.end()));
 }
 
 QString Des::SetKey(const QString &key)
@@ -51,105 +110,26 @@ QString Des::SetInitVec(const QString &target)
     return record;
 }
 
-QString Des::EncodeECB(const QString &message)
-{
-    QString result;
-    subkey = GenerateCiphers(key);
-    std::string text = message.toStdString();
-    std::string record;
-    int length = text.size();
-    int groups = length/8;
-    for(auto x = 0;x < groups;++x){
-        std::string substr = text.substr(x*8,8);
-        std::bitset<64> target = CharToBitset(substr);
-        std::bitset<64> cipher = EncryPerGroup(target);
-        record += cipher.to_string();
-    }
-
-    // 对剩余的不足64进行操作
-    if(groups*8 < length){
-        std::string substr = text.substr(groups*8);
-        int len = substr.length();
-        for(auto x = len;x < 8;++x)substr.push_back('\0');
-        std::bitset<64> target = this->CharToBitset(substr);
-        std::bitset<64> cipher = EncryPerGroup(target);
-        record += cipher.to_string();
-    }
-    result = QString::fromStdString(record);
-    return result;
-}
-
-QString Des::DecodeECB(const QString &message)
+void Des::SetKeyBytes(const uint8_t *key)
 {
-    QString result;
-    subkey = GenerateCiphers(key);
-    std::string text = message.toStdString();
-    std::string record;
-    int length = text.size();
-    int groups = length/64;
-    for(auto x = 0;x < groups;++x){
-        std::string substr = text.substr(x*64,64);
-        std::bitset<64> target(substr);
-        std::bitset<64> answer = DecryPerGroup(target);
-        record += BitsetToChar(answer);
-    }
-    result = QString::fromStdString(record);
-    return result;
+    this->key = BytesToBitset(key);
 }
 
-QString Des::EncodeCBC(const QString &message)
+void Des::SetInitVecBytes(const uint8_t *initVec)
 {
-    QString result;
-    subkey = GenerateCiphers(key);
-    std::string text = message.toStdString();
-    std::string record;
-    int length = text.size();
-    int groups = length/8;
-    for(auto x = 0;x < groups;++x){
-        std::string substr = text.substr(x*8,8);
-        std::bitset<64> target = CharToBitset(substr);
-        target = target ^ keyInitVec;
-        std::bitset<64> cipher = EncryPerGroup(target);
-        keyInitVec = cipher;
-        record += cipher.to_string();
-    }
-
-    // 对剩余的不足64进行操作
-    if(groups*8 < length){
-        std::string substr = text.substr(groups*8);
-        int len = substr.length();
-        for(auto x = len;x < 8;++x)substr.push_back('\0');
-        std::bitset<64> target = this->CharToBitset(substr);
-        target = target ^ keyInitVec;
-        std::bitset<64> cipher = EncryPerGroup(target);
-        keyInitVec = cipher;
-        record += cipher.to_string();
-    }
-    result = QString::fromStdString(record);
-    return result;
+    this->keyInitVec = BytesToBitset(initVec);
 }
 
-QString Des::DecodeCBC(const QString &message)
+std::bitset<64> Des::CharToBitset(const std::string &target)
 {
-    QString result;
-    subkey = GenerateCiphers(key);
-    std::string text = message.toStdString();
-    std::string record;
-    int length = text.size();
-    int groups = length/64;
-    for(auto x = 0;x < groups;++x){
-        std::string substr = text.substr(x*64,64);
-        std::bitset<64> target(substr);
-        std::bitset<64> answer = DecryPerGroup(target);
-        answer = answer ^ keyInitVec;
-        keyInitVec = target;
-        record += BitsetToChar(answer);
-    }
-    result = QString::fromStdString(record);
-    return result;
+    std::bitset<64> bits;
+    for(int i=0; i<8; ++i)
+        for(int j=0; j<8; ++j)
+            bits[i*8+j] = ((target[i]>>j) & 1);
+    return bits;
 }
 
-std::bitset<64> Des::CharToBitset(const std::string &target)
+std::bitset<64> Des::BytesToBitset(const uint8_t *target)
 {
     std::bitset<64> bits;
     for(int i=0; i<8; ++i)
@@ -158,18 +138,14 @@ std::bitset<64> Des::CharToBitset(const std::string &target)
     return bits;
 }
 
-std::string Des::BitsetToChar(const std::bitset<64> &target)
+void Des::BitsetToBytes(const std::bitset<64> &target, uint8_t *result)
 {
-    std::string result;
     for(auto x = 0;x < 8;++x){
-        char tmp1 = '\0';
-        std::bitset<8> det;
+        uint8_t tmp = 0;
         for(auto y = 0;y < 8;++y)
-            det[y] = target[x*8+y];
-        tmp1 = static_cast<char>(det.to_ulong());
-        result.push_back(tmp1);
+            tmp |= static_cast<uint8_t>(target[x*8+y]) << y;
+        result[x] = tmp;
     }
-    return result;
 }
 
 std::bitset<64> Des::EncryPerGroup(const std::bitset<64> &target)
@@ -8,26 +8,25 @@ public:
     Des();
     virtual ~Des();
 
+    virtual bool encrypt(const uint8_t *in, uint8_t *out, size_t len);
+    virtual bool decrypt(const uint8_t *in, uint8_t *out, size_t len);
+    // 密文格式:每组为64个'0'/'1'
     virtual QString EncodeMessage(const QString &message);
     virtual QString DecodeMessage(const QString &message);
     virtual QString SetKey(const QString &key);
     virtual QString SetInitVec(const QString &target);
+    virtual void SetKeyBytes(const uint8_t *key);    // 8字节
+    virtual void SetInitVecBytes(const uint8_t *initVec);    // 8字节
 
 private:
     std::bitset<64> key;                // 64位密钥
     std::bitset<64> keyInitVec;         // 初始向量
     std::vector<std::bitset<48>> subkey;// 16个子密钥
 
-    /* -------------------两种模式---------------- */
-    QString EncodeECB(const QString &message);
-    QString DecodeECB(const QString &message);
-    QString EncodeCBC(const QString &message);
-    QString DecodeCBC(const QString &message);
-
-
     /* -------------------辅助函数---------------- */
     std::bitset<64> CharToBitset(const std::string &target);
-    std::string     BitsetToChar(const std::bitset<64> &target);
+    std::bitset<64> BytesToBitset(const uint8_t *target);
+    void            BitsetToBytes(const std::bitset<64> &target, uint8_t *result);
 
     // 每组加密/解密
     std::bitset<64> EncryPerGroup(const std::bitset<64> &target);
@@ -1,4 +1,47 @@
 #include "Encryption.h"
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+const size_t lanes = 8;    // 每次一起交给算法的组数
+const size_t segment_bytes = 1 << 16;    // 交给线程池的最小数据量
+
+// out = a ^ b,每次处理8个字节,out可以与a或b相同
+inline void XorBytes(uint8_t *out, const uint8_t *a, const uint8_t *b, size_t n)
+{
+    size_t i = 0;
+    for(; i+8 <= n; i += 8){
+        uint64_t x, y;
+        std::memcpy(&x, a+i, 8);
+        std::memcpy(&y, b+i, 8);
+        x ^= y;
+        std::memcpy(out+i, &x, 8);
+    }
+    for(; i < n; ++i)
+        out[i] = a[i] ^ b[i];
+}
+
+// 线程池中执行的一段任务,完成后释放一次信号量
+class RangeTask : public QRunnable
+{
+public:
+    RangeTask(const std::function<void(size_t, size_t)> &task, size_t begin, size_t end, QSemaphore &done)
+        : task(task), begin(begin), end(end), done(done) {}
+    void run() override
+    {
+        task(begin, end);
+        done.release();
+    }
+private:
+    const std::function<void(size_t, size_t)> &task;
+    size_t begin, end;
+    QSemaphore &done;
+};
+}
 
 Encryption::Encryption()
 {
@@ -15,16 +58,36 @@ Encryption::~Encryption()
     // abstract class
 }
 
+bool Encryption::encrypt(const uint8_t *in, uint8_t *out, size_t len)
+{
+    // abstract class
+    Q_UNUSED(in);
+    Q_UNUSED(out);
+    Q_UNUSED(len);
+    return false;
+}
+
+bool Encryption::decrypt(const uint8_t *in, uint8_t *out, size_t len)
+{
+    // abstract class
+    Q_UNUSED(in);
+    Q_UNUSED(out);
+    Q_UNUSED(len);
+    return false;
+}
+
 QString Encryption::EncodeMessage(const QString &message)
 {
     // abstract class
     Q_UNUSED(message);
+    return QString();
 }
 
 QString Encryption::DecodeMessage(const QString &message)
 {
     // abstract class
     Q_UNUSED(message);
+    return QString();
 }
 
 QString Encryption::SetKey(const QString &key)
@@ -41,3 +104,114 @@ QString Encryption::SetInitVec(const QString &target)
     return QString();
 }
 
+void Encryption::SetKeyBytes(const uint8_t *key)
+{
+    // abstract class
+    Q_UNUSED(key);
+}
+
+void Encryption::SetInitVecBytes(const uint8_t *initVec)
+{
+    // abstract class
+    Q_UNUSED(initVec);
+}
+
+
+void Encryption::ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &task)
+{
+    QThreadPool *pool = QThreadPool::globalInstance();
+    const size_t threads = static_cast<size_t>(std::max(1, pool->maxThreadCount()));
+    const size_t parts = std::min(threads, count/std::max<size_t>(grain, 1));
+    if(parts <= 1){
+        task(0, count);
+        return;
+    }
+    const size_t step = (count+parts-1)/parts;
+    QSemaphore done;
+    int submitted = 0;
+    for(size_t begin = step; begin < count; begin += step, ++submitted)
+        pool->start(new RangeTask(task, begin, std::min(count, begin+step), done));
+    task(0, step);
+    done.acquire(submitted);
+}
+
+void Encryption::ProcessECB(const uint8_t *in, uint8_t *out, size_t groups, size_t size, const GroupCipher &cipher)
+{
+    ParallelFor(groups, segment_bytes/size, [=, &cipher](size_t begin, size_t end){
+        if(in != out)
+            std::memcpy(out+begin*size, in+begin*size, (end-begin)*size);
+        cipher(out+begin*size, end-begin);
+    });
+}
+
+void Encryption::EncodeCBC(const uint8_t *in, uint8_t *out, size_t groups, size_t size,
+                           uint8_t *chain, const GroupCipher &encrypt)
+{
+    // 每组依赖前一组的密文,只能逐组进行
+    for(size_t x = 0; x < groups; ++x){
+        uint8_t *target = out+x*size;
+        XorBytes(target, in+x*size, chain, size);
+        encrypt(target, 1);
+        std::memcpy(chain, target, size);
+    }
+}
+
+void Encryption::DecodeCBC(const uint8_t *in, uint8_t *out, size_t groups, size_t size,
+                           uint8_t *chain, const GroupCipher &decrypt)
+{
+    if(groups == 0)
+        return;
+    // 解密时各组互不依赖:按组的边界分段交给线程池,每段每次取8组一起解密,再与各自前一组密文异或。
+    // 原地解密会覆盖密文,所以先记下每段之前的那一组密文,段内则保留当前8组密文的副本
+    const size_t step = std::max<size_t>(segment_bytes/size, lanes);
+    const size_t segments = (groups+step-1)/step;
+    std::vector<uint8_t> previous(segments*size);
+    std::memcpy(previous.data(), chain, size);
+    for(size_t s = 1; s < segments; ++s)
+        std::memcpy(previous.data()+s*size, in+(s*step-1)*size, size);
+    std::memcpy(chain, in+(groups-1)*size, size);
+
+    ParallelFor(segments, 1, [=, &previous, &decrypt](size_t begin, size_t end){
+        uint8_t saved[lanes*16], last[16];
+        for(size_t s = begin; s < end; ++s){
+            std::memcpy(last, previous.data()+s*size, size);
+            for(size_t x = s*step; x < std::min(groups, (s+1)*step); x += lanes){
+                const size_t n = std::min(lanes, groups-x);
+                uint8_t *target = out+x*size;
+                std::memcpy(saved, in+x*size, n*size);
+                std::memcpy(target, saved, n*size);
+                decrypt(target, n);
+                XorBytes(target, target, last, size);
+                XorBytes(target+size, target+size, saved, (n-1)*size);
+                std::memcpy(last, saved+(n-1)*size, size);
+            }
+        }
+    });
+}
+
+void Encryption::CryptCTR(const uint8_t *in, uint8_t *out, size_t length, size_t size,
+                          const uint8_t *initVec, const GroupCipher &encrypt)
+{
+    // 计数器分组互不依赖:大块数据按段交给线程池,每段从自己的起始计数器开始,
+    // 每次生成8个计数器分组一起加密后再与数据异或
+    const size_t groups = (length+size-1)/size;
+    ParallelFor(groups, segment_bytes/size, [=, &encrypt](size_t begin, size_t end){
+        uint8_t counter[16], stream[lanes*16];
+        std::memcpy(counter, initVec, size);
+        uint64_t carry = begin;    // 初始向量加上本段的起始序号
+        for(size_t i = size; i-- > 0 && carry; ){
+            carry += counter[i];
+            counter[i] = static_cast<uint8_t>(carry);
+            carry >>= 8;
+        }
+        for(size_t x = begin; x < end; x += lanes){
+            const size_t n = std::min(lanes, end-x);
+            for(size_t i = 0; i < n; ++i){
+                std::memcpy(stream+i*size, counter, size);
+                for(size_t j = size; j-- > 0 && ++counter[j] == 0; );    // 计数器加1
+            }
+            encrypt(stream, n);
+            XorBytes(out+x*size, in+x*size, stream, std::min(n*size, length-x*size));
+        }
+    });
+}
@@ -2,11 +2,14 @@
 #define ENCRYPTION_H
 #include <QObject>
 #include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 
 class Encryption
 {
 public:
-    enum MODE{ECB=0,CBC=1};
+    enum MODE{ECB=0,CBC=1,CTR=2};
 
     Encryption();
     void setMode(int index);
@@ -14,11 +17,38 @@ public:
     virtual ~Encryption();
     virtual QString SetKey(const QString &key);
     virtual QString SetInitVec(const QString &target);
+    // 直接设置密钥和初始向量的各字节,长度分别为算法的密钥长度和分组长度,可以表示文本无法表示的任意字节
+    virtual void SetKeyBytes(const uint8_t *key);
+    virtual void SetInitVecBytes(const uint8_t *initVec);
 
+    // 字节接口:按当前模式加密/解密len字节写入out,in与out可以是同一块缓冲区(原地处理)。
+    // ECB、CBC模式的len必须是分组长度的整数倍,否则返回false;CTR模式可以是任意长度。
+    // 每次调用都从SetInitVec设置的初始向量开始,不改变对象的状态
+    virtual bool encrypt(const uint8_t *in, uint8_t *out, size_t len);
+    virtual bool decrypt(const uint8_t *in, uint8_t *out, size_t len);
+
+    // 界面使用的文本接口:明文末尾补'\0'到整组,密文为各算法自己的文本格式
     virtual QString EncodeMessage(const QString &message);
     virtual QString DecodeMessage(const QString &message);
 protected:
     MODE mode;
+
+    // 把[0,count)分成若干段,除第一段在当前线程执行外都交给全局线程池,全部完成后返回;
+    // 每段至少grain个,数量不足两段时直接在当前线程执行。task的参数为段的起止下标
+    static void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &task);
+
+    /* -------------各模式的通用流程,size为分组字节数(不超过16),in与out可以相同---------------- */
+    // 对连续count组原地加密或解密,由各算法提供
+    typedef std::function<void(uint8_t *groups, size_t count)> GroupCipher;
+    static void ProcessECB(const uint8_t *in, uint8_t *out, size_t groups, size_t size, const GroupCipher &cipher);
+    // chain传入初始向量,返回时为最后一组密文
+    static void EncodeCBC(const uint8_t *in, uint8_t *out, size_t groups, size_t size,
+                          uint8_t *chain, const GroupCipher &encrypt);
+    static void DecodeCBC(const uint8_t *in, uint8_t *out, size_t groups, size_t size,
+                          uint8_t *chain, const GroupCipher &decrypt);
+    // 第i组与加密后的(初始向量+i)异或,初始向量视为大端序整数;加解密相同
+    static void CryptCTR(const uint8_t *in, uint8_t *out, size_t length, size_t size,
+                         const uint8_t *initVec, const GroupCipher &encrypt);
 };
 
 #endif // ENCRYPTION_H
@@ -0,0 +1,28 @@
+#-------------------------------------------------
+#
+# AES/DES mode regression checks (Qt core only, no GUI)
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+CONFIG   += console c++14 thread
+CONFIG   -= app_bundle
+
+TARGET = Check
+TEMPLATE = app
+
+INCLUDEPATH += ../Algorithm
+
+SOURCES += \
+        main.cpp \
+    ../Algorithm/AES.cpp \
+    ../Algorithm/AES_NI.cpp \
+    ../Algorithm/Des.cpp \
+    ../Algorithm/Encryption.cpp
+
+HEADERS += \
+    ../Algorithm/AES.h \
+    ../Algorithm/AES_NI.h \
+    ../Algorithm/Des.h \
+    ../Algorithm/Encryption.h
@@ -0,0 +1,188 @@
+/**
+ * AES与DES各工作模式的回归检查,不需要界面。
+ * AES用NIST SP 800-38A附录F.1.1、F.2.1、F.5.1的向量检查ECB、CBC、CTR,本项目的数据按行存放,向量先逐组转置;
+ * 本项目的DES位序与FIPS 81不同,ECB、CBC用原实现记录下来的结果检查,CTR用加入该模式时记录的结果。
+ * 另外对超过线程池分段长度的随机数据,把各模式的分段并行实现与逐组计算的结果对照,非原地与原地各做一次。
+ * 任一检查失败时返回非0。
+ * 用法:Check
+ */
+#include <QThreadPool>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "AES.h"
+#include "Des.h"
+
+namespace {
+
+typedef std::vector<uint8_t> Bytes;
+
+const char * const mode_names[] = {"ECB", "CBC", "CTR"};
+const size_t segment_bytes = 1 << 16;    // 与Encryption.cpp中交给线程池的最小数据量相同
+int failures = 0;    // 检查失败的次数
+std::mt19937 engine(20180610);    // 固定种子,保证每次运行的数据相同
+
+/**
+ * 函数功能:输出一行检查结果,并记录失败次数
+ * 参数含义:name代表算法,mode代表工作模式,what代表数据来源,bytes代表数据长度,ok代表检查是否通过
+ */
+void Report(const char * name, int mode, const char * what, size_t bytes, bool ok) {
+    std::printf("%-4s %-4s %-14s %10zu   %s\n", name, mode_names[mode], what, bytes, ok ? "ok" : "FAILED");
+    if (!ok)
+        ++failures;
+}
+
+Bytes FromHex(const std::string & hex) {
+    Bytes ans(hex.size()/2);
+    for (size_t i=0; i<ans.size(); ++i)
+        ans[i] = (uint8_t)std::stoi(hex.substr(2*i, 2), nullptr, 16);
+    return ans;
+}
+
+Bytes RandomBytes(size_t n) {
+    Bytes ans(n);
+    for (auto & x : ans)
+        x = (uint8_t)engine();
+    return ans;
+}
+
+/**
+ * 函数功能:把按标准列序给出的16字节分组转为按行存放,对自身是逆运算
+ */
+Bytes Transpose(const Bytes & data) {
+    Bytes ans(data.size());
+    for (size_t x=0; x<data.size(); x+=16)
+        for (size_t i=0; i<16; ++i)
+            ans[x+(i%4)*4+i/4] = data[x+i];
+    return ans;
+}
+
+/**
+ * 函数功能:非原地与原地各加密一次,检查密文与期望相同,再分别解密检查能否还原
+ * 参数含义:cipher代表已设置密钥和初始向量的算法,mode代表工作模式,plain、expect代表明文和期望的密文
+ */
+bool RoundTrip(Encryption & cipher, int mode, const Bytes & plain, const Bytes & expect) {
+    cipher.setMode(mode);
+    Bytes out(plain.size()), back(plain.size()), inplace(plain);
+    return cipher.encrypt(plain.data(), out.data(), plain.size()) && out == expect
+            && cipher.encrypt(inplace.data(), inplace.data(), inplace.size()) && inplace == expect
+            && cipher.decrypt(out.data(), back.data(), out.size()) && back == plain
+            && cipher.decrypt(inplace.data(), inplace.data(), inplace.size()) && inplace == plain;
+}
+
+/**
+ * 函数功能:逐组计算各模式的密文作为参考,每次只交给ECB一组,不经过分段和流水线
+ * 参数含义:cipher代表已设置密钥的算法,mode代表工作模式,size代表分组字节数,initVec代表初始向量,plain代表明文
+ */
+Bytes Reference(Encryption & cipher, int mode, size_t size, const Bytes & initVec, const Bytes & plain) {
+    cipher.setMode(Encryption::ECB);
+    Bytes ans(plain.size()), chain(initVec), block(size);
+    for (size_t x=0; x<plain.size(); x+=size) {
+        const size_t n = std::min(size, plain.size()-x);
+        if (mode == Encryption::CTR) {
+            block = chain;
+            cipher.encrypt(block.data(), block.data(), size);
+            for (size_t i=0; i<n; ++i)
+                ans[x+i] = plain[x+i]^block[i];
+            for (size_t j=size; j-- > 0 && ++chain[j] == 0; );    // 计数器按大端序加1
+            continue;
+        }
+        for (size_t i=0; i<size; ++i)
+            block[i] = mode == Encryption::CBC ? plain[x+i]^chain[i] : plain[x+i];
+        cipher.encrypt(block.data(), block.data(), size);
+        std::copy(block.begin(), block.end(), ans.begin()+x);
+        chain = block;
+    }
+    return ans;
+}
+
+void CheckAESVectors() {
+    const Bytes key = FromHex("2b7e151628aed2a6abf7158809cf4f3c");
+    const Bytes plain = Transpose(FromHex("6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+                                          "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710"));
+    AES aes;
+    aes.SetKeyBytes(key.data());
+
+    Report("AES", Encryption::ECB, "SP 800-38A", plain.size(), RoundTrip(aes, Encryption::ECB, plain,
+           Transpose(FromHex("3ad77bb40d7a3660a89ecaf32466ef97f5d3d58503b9699de785895a96fdbaaf"
+                             "43b1cd7f598ece23881b00e3ed0306887b0c785e27e8ad3f8223207104725dd4"))));
+
+    aes.SetInitVecBytes(Transpose(FromHex("000102030405060708090a0b0c0d0e0f")).data());
+    Report("AES", Encryption::CBC, "SP 800-38A", plain.size(), RoundTrip(aes, Encryption::CBC, plain,
+           Transpose(FromHex("7649abac8119b246cee98e9b12e9197d5086cb9b507219ee95db113a917678b2"
+                             "73bed6b8e3c1743b7116e69e222295163ff1caa1681fac09120eca307586e1a7"))));
+
+    // 计数器按存放顺序做大端加法,与标准的字节序不同,所以每组单独从向量给出的计数器开始
+    const Bytes counters = FromHex("f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff" "f0f1f2f3f4f5f6f7f8f9fafbfcfdff00"
+                                   "f0f1f2f3f4f5f6f7f8f9fafbfcfdff01" "f0f1f2f3f4f5f6f7f8f9fafbfcfdff02");
+    const Bytes cipher = Transpose(FromHex("874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff"
+                                           "5ae4df3edbd5d35e5b4f09020db03eab1e031dda2fbe03d1792170a0f3009cee"));
+    bool ok = true;
+    for (size_t x=0; x<plain.size(); x+=16) {
+        aes.SetInitVecBytes(Transpose(Bytes(counters.begin()+x, counters.begin()+x+16)).data());
+        ok = RoundTrip(aes, Encryption::CTR, Bytes(plain.begin()+x, plain.begin()+x+16),
+                       Bytes(cipher.begin()+x, cipher.begin()+x+16)) && ok;
+    }
+    Report("AES", Encryption::CTR, "SP 800-38A", plain.size(), ok);
+}
+
+void CheckDESVectors() {
+    const std::string text = "Now is the time for all ";
+    const Bytes plain(text.begin(), text.end());
+    const char * const expect[] = {"1ef89fa9ea4d0ce38d60e188172508761ae837767ad28d95",
+                                   "1aa079b94ed2aacbcb71529d37a0061acf31289464cc1883",
+                                   "74a26e13062b23a747a08acaa166e8952d0b6dca89f26e2d"};
+    Des des;
+    des.SetKeyBytes(FromHex("0123456789abcdef").data());
+    des.SetInitVecBytes(FromHex("1234567890abcdef").data());
+    for (int mode=Encryption::ECB; mode<=Encryption::CTR; ++mode)
+        Report("DES", mode, "known answer", plain.size(), RoundTrip(des, mode, plain, FromHex(expect[mode])));
+}
+
+/**
+ * 函数功能:对各种长度的随机数据,检查各模式与逐组计算的结果相同。最长的数据超过三个分段,
+ *          CTR另用低位全为0xff的初始向量,使计数器的进位跨过分段的边界
+ * 参数含义:cipher代表算法,name代表算法名,size代表分组字节数
+ */
+void CheckSegments(Encryption & cipher, const char * name, size_t size) {
+    const size_t groups[] = {1, 7, 8, 9, 3*segment_bytes/size+5};
+    cipher.SetKeyBytes(RandomBytes(16).data());
+    for (int mode=Encryption::ECB; mode<=Encryption::CTR; ++mode) {
+        for (size_t count : groups) {
+            const size_t bytes = count*size+(mode == Encryption::CTR ? 3 : 0);    // CTR的最后一组不完整
+            Bytes initVec = RandomBytes(size);
+            if (mode == Encryption::CTR && count > 9)
+                std::fill(initVec.begin()+size/2, initVec.end(), 0xff);
+            cipher.SetInitVecBytes(initVec.data());
+            const Bytes plain = RandomBytes(bytes);
+            const Bytes expect = Reference(cipher, mode, size, initVec, plain);
+            Report(name, mode, "segments", bytes, RoundTrip(cipher, mode, plain, expect));
+        }
+    }
+}
+
+}
+
+int main()
+{
+    // 保证大块数据确实被拆到多个线程上
+    QThreadPool::globalInstance()->setMaxThreadCount(std::max(4, QThreadPool::globalInstance()->maxThreadCount()));
+    if (!AES::SelfTest()) {
+        std::printf("AES self test FAILED\n");
+        return 1;
+    }
+    std::printf("AES-NI: %s\n", AES::HardwareAccelerated() ? "yes" : "no");
+    std::printf("%-4s %-4s %-14s %10s   %s\n", "alg", "mode", "data", "bytes", "check");
+    CheckAESVectors();
+    CheckDESVectors();
+    AES aes;
+    CheckSegments(aes, "AES", 16);
+    Des des;
+    CheckSegments(des, "DES", 8);
+    if (failures)
+        std::printf("%d check(s) FAILED\n", failures);
+    return failures ? 1 : 0;
+}
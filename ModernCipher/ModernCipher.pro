@@ -8,6 +8,9 @@ QT       += core gui
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
+# AES lookup tables are generated by constexpr functions.
+CONFIG   += c++14
+
 TARGET = ModernCipher
 TEMPLATE = app
 
@@ -28,13 +31,15 @@ SOURCES += \
         Widget.cpp \
     Algorithm/Encryption.cpp \
     Algorithm/Des.cpp \
-    Algorithm/AES.cpp
+    Algorithm/AES.cpp \
+    Algorithm/AES_NI.cpp
 
 HEADERS += \
         Widget.h \
     Algorithm/Encryption.h \
     Algorithm/Des.h \
-    Algorithm/AES.h
+    Algorithm/AES.h \
+    Algorithm/AES_NI.h
 
 FORMS += \
         Widget.ui
@@ -1,9 +1,16 @@
 #include "Widget.h"
 #include <QApplication>
+#include <QMessageBox>
+#include "Algorithm/AES.h"
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+    // 启动时检查AES的各个实现,AES-NI出错会自动退回查表实现
+    if(!AES::SelfTest()){
+        QMessageBox::critical(nullptr, QObject::tr("ModernCipher"), QObject::tr("AES自检失败"));
+        return 1;
+    }
     Widget w;
     w.show();
 
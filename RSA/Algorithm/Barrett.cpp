@@ -0,0 +1,105 @@
+#include <cassert>
+#include "Barrett.h"
+
+/**
+ * 函数功能:根据给定的模数构造Barrett上下文,预先计算mu=floor(b^(2k)/n)
+ * 参数含义:m代表模数,必须为正数
+ */
+Barrett::Barrett(const BigInteger & m): n(m), k(0) {
+    assert(!n.is_negative && !n.equals(BigInteger::ZERO));
+    k = n.data.size();
+    BigInteger r = BigInteger::ONE;
+    r <<= (unsigned)(2*k*BigInteger::base_int);
+    mu = r.divide(n);
+}
+
+/**
+ * 函数功能:利用事先保存的mu恢复上下文
+ * 参数含义:m代表正模数,factor代表floor(b^(2k)/m)
+ */
+Barrett::Barrett(const BigInteger & m, const BigInteger & factor): n(m), mu(factor), k(0) {
+    assert(!n.is_negative && !n.equals(BigInteger::ZERO));
+    k = n.data.size();
+    assert(mu.data.size() > k);    // n<b^k,mu>b^k
+}
+
+/**
+ * 函数功能:求x mod n,结果非负
+ * 参数含义:x代表被约减的数
+ */
+BigInteger Barrett::reduce(const BigInteger & x) const {
+    BigInteger ans(x);
+    reduceInPlace(ans);
+    return ans;
+}
+
+/**
+ * 函数功能:原位求x mod n(HAC算法14.42)。q=floor(floor(x/b^(k-1))*mu/b^(k+1))比真实的商
+ *          略小,x-q*n只需在模b^(k+1)下计算,再减去少数几次n。两次乘法都只算用得到的部分:
+ *          q1*mu省略第k-1列以下的项(只会让商再小1),q*n只算低k+1位。
+ *          x的位数超过2k时退回长除法,负数的结果与mod一致,落在[0,n)中
+ * 参数含义:x代表被约减的数,结果直接写回
+ */
+void Barrett::reduceInPlace(BigInteger & x) const {
+    typedef BigInteger::base_t base_t;
+    typedef BigInteger::dbl_t dbl_t;
+    typedef InlineVector<base_t, BigInteger::inline_limbs> Limbs;
+    assert(isValid());
+    const bool negative = x.is_negative;
+    x.is_negative = false;
+    if (x.compareAbs(n) >= 0) {
+        if (x.data.size() > 2*k) {
+            x %= n;
+        }
+        else {
+            const int w = BigInteger::base_int;
+            const base_t * xp = x.data.data();
+            const base_t * mp = mu.data.data();
+            const base_t * np = n.data.data();
+            const size_t nq = x.data.size()-(k-1);    // q1=floor(x/b^(k-1))的位数
+            const size_t nm = mu.data.size();
+
+            // q2=q1*mu,只计算第k-1列及以上
+            Limbs q2;
+            q2.assign(nq+nm, 0);
+            for (size_t i=0; i<nq; ++i) {
+                const dbl_t a = xp[k-1+i];
+                dbl_t carry = 0;
+                for (size_t j=(i<k-1 ? k-1-i : 0); j<nm; ++j) {
+                    carry += a*mp[j]+q2[i+j];
+                    q2[i+j] = (base_t)carry;
+                    carry >>= w;
+                }
+                q2[i+nm] = (base_t)carry;
+            }
+
+            // r2=q3*n mod b^(k+1),q3=floor(q2/b^(k+1))
+            const base_t * q3 = q2.data()+k+1;
+            const size_t n3 = nq+nm-(k+1);
+            Limbs r2;
+            r2.assign(k+1, 0);
+            for (size_t i=0; i<n3 && i<=k; ++i) {
+                const dbl_t a = q3[i];
+                dbl_t carry = 0;
+                for (size_t j=0; j<k && i+j<=k; ++j) {
+                    carry += a*np[j]+r2[i+j];
+                    r2[i+j] = (base_t)carry;
+                    carry >>= w;
+                }
+                if (i == 0)
+                    r2[k] = (base_t)carry;
+            }
+
+            // 只保留低k+1位相减,借位自然丢弃
+            x.data.resize(k+1);
+            BigInteger::subLimbs(x.data.data(), x.data.data(), k+1, r2.data(), k+1);
+            x.trim();
+            while (x.compareAbs(n) >= 0) {
+                BigInteger::subLimbs(x.data.data(), x.data.data(), x.data.size(), np, k);
+                x.trim();
+            }
+        }
+    }
+    if (negative && !x.equals(BigInteger::ZERO))
+        x.subAbs(n);    // |x|<n,结果为n-|x|
+}
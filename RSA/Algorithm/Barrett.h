@@ -0,0 +1,28 @@
+#ifndef BARRETT_H
+#define BARRETT_H
+#include "BigInteger.h"
+
+/**
+ * Barrett约减上下文:对固定的正模数n预先计算mu=floor(b^(2k)/n),其中b=2^base_int,k为n的位数。
+ * 之后对小于b^(2k)的数取模只需两次乘法和少量减法,不需要长除法,
+ * 也不像蒙哥马利那样要求奇数模数或转换形式,适合对同一模数的零散取模
+ */
+class Barrett {
+public:
+    Barrett(): k(0) {}    // 默认为空上下文
+    explicit Barrett(const BigInteger &);    // 利用给定的正模数初始化
+    Barrett(const BigInteger &, const BigInteger &);    // 利用保存的模数和mu恢复,不再做除法
+
+    bool isValid() const { return k != 0; }    // 是否已经初始化
+    const BigInteger & modulus() const { return n; }    // 返回模数
+    const BigInteger & reciprocal() const { return mu; }    // 返回mu
+
+    BigInteger reduce(const BigInteger &) const;    // 返回x mod n,结果非负
+    void reduceInPlace(BigInteger &) const;    // 原位求x mod n
+private:
+    BigInteger n;    // 模数
+    BigInteger mu;    // floor(b^(2k)/n)
+    size_t k;    // 模数的位数
+};
+
+#endif // BARRETT_H
@@ -1,7 +1,10 @@
 #include <algorithm>
 #include <cassert>
-#include <cctype>
+#include <cstring>
+#include <utility>
 #include "BigInteger.h"
+#include "Montgomery.h"
+#include "Barrett.h"
 
 // 以下表示为静态常量赋值
 const BigInteger BigInteger::ZERO = BigInteger(0);
@@ -9,12 +12,80 @@ const BigInteger BigInteger::ONE = BigInteger(1);
 const BigInteger BigInteger::TWO = BigInteger(2);
 const BigInteger BigInteger::TEN = BigInteger(10);
 
+namespace {
+// 十六进制字符到数值的对照表,非法字符视为0
+struct HexValueTable {
+    unsigned char value[256];
+    HexValueTable() {
+        std::fill(value, value+256, 0);
+        for (int i=0; i<10; ++i)
+            value['0'+i] = (unsigned char)i;
+        for (int i=0; i<6; ++i)
+            value['a'+i] = value['A'+i] = (unsigned char)(10+i);
+    }
+};
+
+// 一个字节对应的两个十六进制字符,依次为"00","01",...,"FF"
+struct HexPairTable {
+    char pairs[512];
+    HexPairTable() {
+        static const char hex_table[] = "0123456789ABCDEF";
+        for (int i=0; i<256; ++i) {
+            pairs[2*i] = hex_table[i>>4];
+            pairs[2*i+1] = hex_table[i&0xf];
+        }
+    }
+};
+
+// 局部静态变量保证在其它全局对象构造时也已初始化
+const unsigned char * hexValues() {
+    static const HexValueTable table;
+    return table.value;
+}
+
+const char * hexPairs() {
+    static const HexPairTable table;
+    return table.pairs;
+}
+}
+
 /**
  * 函数功能:根据给定的大整数构造一个新的大整数
  * 参数含义:val代表给定的大整数
  */
-BigInteger::BigInteger(const BigInteger & val) {
-    *this = val;
+BigInteger::BigInteger(const BigInteger & val): is_negative(val.is_negative), data(val.data) {}
+
+/**
+ * 函数功能:接管给定大整数的数据构造一个新的大整数,数据在堆上时不复制
+ * 参数含义:val代表给定的大整数,之后变为0
+ */
+BigInteger::BigInteger(BigInteger && val) noexcept: is_negative(val.is_negative), data(std::move(val.data)) {
+    val.is_negative = false;
+    val.data.assign(1, 0);
+}
+
+/**
+ * 函数功能:复制赋值,数据位数不超过已有容量时不重新申请内存
+ * 参数含义:val代表给定的大整数
+ */
+BigInteger & BigInteger::operator = (const BigInteger & val) {
+    is_negative = val.is_negative;
+    data = val.data;
+    return *this;
+}
+
+/**
+ * 函数功能:移动赋值,接管给定大整数的数据
+ * 参数含义:val代表给定的大整数,之后变为0
+ */
+BigInteger & BigInteger::operator = (BigInteger && val) noexcept {
+    if (this != &val) {
+        is_negative = val.is_negative;
+        data = std::move(val.data);
+        val.is_negative = false;
+        val.data.assign(1, 0);
+    }
+    return *this;
 }
 
 /**
@@ -22,31 +93,26 @@ BigInteger::BigInteger(const BigInteger & val) {
  * 参数含义:str代表给定的数据
  */
 BigInteger::BigInteger(const std::string & str): is_negative(false) {
-    std::string t(str);
-    if (t.size() && t.at(0)=='-') {
-        if (t.size() > 1)
-            is_negative = true;
-        t = t.substr(1);
+    const unsigned char * value = hexValues();
+    size_t begin = 0, end = str.size();
+    if (end && str[0]=='-') {
+        is_negative = true;
+        begin = 1;
     }
-    int cnt = (8-(t.size()%8))%8;// 数的长度不是8的倍数,补足0
-    std::string temp;
-
-    for (int i=0; i<cnt; ++i)
-        temp.push_back('0');
-
-    t = temp+t;
-
-    for (size_t i=0; i<t.size(); i+=base_char) {
+    // 从字符串末尾开始,每base_char个字符查表拼成一位,最高一位可能不足base_char个字符
+    const size_t n = (end-begin+base_char-1)/base_char;
+    data.assign(std::max<size_t>(n, 1), 0);
+    for (size_t i=0; i<n; ++i) {
+        size_t hi = end-i*base_char;
+        size_t lo = hi-begin>(size_t)base_char ? hi-base_char : begin;
         base_t sum = 0;
-        for (int j=0; j<base_char; ++j) {    // 8位十六进制组成大整数的一位
-            char ch = t[i+j];
-            int num = hexToNum(ch);
-            sum = ((sum<<4) | (num));
-        }
-        data.push_back(sum);
+        for (size_t j=lo; j<hi; ++j)
+            sum = (sum<<4) | value[(unsigned char)str[j]];
+        data[i] = sum;
     }
-    reverse(data.begin(), data.end());// 高位在后
-    *this = trim();// 去除高位的0
+    trim();// 去除高位的0
+    if (data.size()==1 && data[0]==0)    // "-0"也是0
+        is_negative = false;
 }
 
 /**
@@ -54,15 +120,16 @@ BigInteger::BigInteger(const std::string & str): is_negative(false) {
  * 参数含义:num代表给定的数据
  */
 BigInteger::BigInteger(const long_t & num): is_negative(false) {
-    long_t t = num;
-    if (t < 0) {
+    unsigned long long t = num;
+    if (num < 0) {
         is_negative = true;
-        t = -t;
+        t = 0-t;    // 按无符号数取反,最小的负数也不会溢出
     }
     do {
-        base_t temp = (t&base_num);    // 每次截取低32位
+        base_t temp = (t&base_num);    // 每次截取低base_int位
         data.push_back(temp);
-        t >>= base_int;
+        t >>= base_int/2;    // 分两次移位,base_int为64时也不会越界
+        t >>= base_int/2;
     } while (t);
 }
 
@@ -72,45 +139,7 @@ BigInteger::BigInteger(const long_t & num): is_negative(false) {
  */
 BigInteger BigInteger::add(const BigInteger & val) {
     BigInteger ans(*this);
-    if (ans.is_negative == val.is_negative) {// 同号
-        int len = val.data.size()-ans.data.size();
-
-        while ((len--) > 0)    // 被加数位数少,高位补0
-            ans.data.push_back(0);
-
-        int carry = 0;    // 进位
-        for (size_t i=0; i<val.data.size(); ++i) {
-            base_t temp = ans.data[i];
-            ans.data[i] += val.data[i]+carry;    // 无符号数相加,超出取其余数
-            // 进位:一种是有无进位都超出,一种是有进位才超出(比如十进制相加,9+9+1,得9,9+0+0,得9)
-            carry = (temp>ans.data[i] ? 1 : (temp>(temp+val.data[i]) ? 1 : 0));
-        }
-
-        for (size_t i=val.data.size(); i<ans.data.size() && carry!=0; ++i) {// 还有进位
-            base_t temp = ans.data[i];
-            ans.data[i] += carry;
-            carry = temp > ans.data[i];
-        }
-
-        if (carry)    // 还有进位
-            ans.data.push_back(carry);
-    }
-    else {    // 异号
-        BigInteger a = abs();
-        BigInteger b = val.abs();
-        int flag = a.compareTo(b);
-        // 绝对值相等,则结果为0,否则用绝对值大的减去小的,符号随绝对值大的
-        if (flag == -1) {
-            ans = b.subtract(a);
-            ans.is_negative = val.is_negative;
-        }
-        else if (flag == 0)
-            ans = ZERO;
-        else {
-            ans = a.subtract(b);
-            ans.is_negative = is_negative;
-        }
-    }
+    ans += val;
     return ans;
 }
 
@@ -120,38 +149,123 @@ BigInteger BigInteger::add(const BigInteger & val) {
  */
 BigInteger BigInteger::subtract(const BigInteger & val) {
     BigInteger ans(*this);
-    BigInteger a = abs();
-    BigInteger b = val.abs();
-    if (ans.is_negative == val.is_negative) {// 同号
-        int flag = a.compareTo(b);
-        if (flag == 1) {// a的绝对值大于b的绝对值,直接减
-            int borrow = 0;    // 借位
-            // 大数减小数
-            for (size_t i=0; i<val.data.size(); ++i) {
-                base_t temp = ans.data[i];
-                ans.data[i] -= val.data[i]+borrow;
-                // 借位:一种是有无借位都超出,另一种是有借位才超出(比如十进制相减,9-0-0,得9,9-9-1,得9)
-                borrow = temp<ans.data[i] ? 1 : (temp-borrow<val.data[i] ? 1 : 0);
-            }
-            for (size_t i=val.data.size(); i<ans.data.size() && borrow!=0; ++i) {// 还有借位
-                base_t temp = ans.data[i];
-                ans.data[i] -= borrow;
-                borrow = temp < (base_t)borrow;
-            }
-            ans = ans.trim();// 去掉高位多余的0
+    ans -= val;
+    return ans;
+}
+
+/**
+ * 函数功能:复合加法运算,结果直接写回当前大整数
+ * 参数含义:val代表加数,可以是当前大整数本身
+ */
+BigInteger & BigInteger::operator += (const BigInteger & val) {
+    if (is_negative == val.is_negative)    // 同号,绝对值相加,符号不变
+        addAbs(val);
+    else {    // 异号,用绝对值大的减去小的,符号随绝对值大的
+        int flag = compareAbs(val);
+        if (flag == 0)
+            *this = ZERO;
+        else {
+            bool negative = (flag == 1) ? is_negative : val.is_negative;
+            subAbs(val);
+            is_negative = negative;
         }
-        else if (flag == 0)
-            ans = ZERO;
-        else {// a的绝对值小于b的绝对值
-            ans = b.subtract(a);
-            ans.is_negative = !is_negative;
+    }
+    return *this;
+}
+
+/**
+ * 函数功能:复合减法运算,结果直接写回当前大整数
+ * 参数含义:val代表减数,可以是当前大整数本身
+ */
+BigInteger & BigInteger::operator -= (const BigInteger & val) {
+    if (is_negative != val.is_negative)    // 异号,转换为绝对值相加,符号不变
+        addAbs(val);
+    else {    // 同号,用绝对值大的减去小的
+        int flag = compareAbs(val);
+        if (flag == 0)
+            *this = ZERO;
+        else {
+            bool negative = (flag == 1) ? is_negative : !is_negative;
+            subAbs(val);
+            is_negative = negative;
         }
     }
-    else {    // 异号
-        ans = a.add(b);    // 转换为加法
-        ans.is_negative = is_negative;
+    return *this;
+}
+
+/**
+ * 函数功能:复合乘法运算
+ * 参数含义:val代表乘数
+ */
+BigInteger & BigInteger::operator *= (const BigInteger & val) {
+    *this = multiply(val);
+    return *this;
+}
+
+/**
+ * 函数功能:复合取余运算,结果符号与被除数相同
+ * 参数含义:val代表除数
+ */
+BigInteger & BigInteger::operator %= (const BigInteger & val) {
+    divideAndRemainder(val, *this);
+    return *this;
+}
+
+/**
+ * 函数功能:复合左移运算,在原有存储上由高到低移动
+ * 参数含义:len代表移位的位数
+ */
+BigInteger & BigInteger::operator <<= (const unsigned len) {
+    if (data.size()==1 && data[0]==0)
+        return *this;
+    size_t index = len>>base_bit;    // 大整数每一位需要移动多少位
+    int shift = len&base_temp;    // 还剩下多少位
+    size_t n = data.size();
+    data.resize(n+index+1, 0);    // 预留一位接收移出的高位
+    base_t * p = data.data();
+    if (shift) {
+        p[n+index] = p[n-1]>>(base_int-shift);
+        for (size_t i=n-1; i>0; --i)
+            p[i+index] = (p[i]<<shift) | (p[i-1]>>(base_int-shift));
+        p[index] = p[0]<<shift;
     }
-    return ans;
+    else {
+        for (size_t i=n; i-->0; )
+            p[i+index] = p[i];
+    }
+    std::fill(p, p+index, 0);
+    trim();
+    return *this;
+}
+
+/**
+ * 函数功能:复合右移运算,在原有存储上由低到高移动
+ * 参数含义:len代表移位的位数
+ */
+BigInteger & BigInteger::operator >>= (const unsigned len) {
+    size_t index = len>>base_bit;    // 大整数每一位需要移动多少位
+    int shift = len&base_temp;    // 还剩下多少位
+    size_t n = data.size();
+    if (index >= n) {    // 移出了全部的位,结果为0
+        *this = ZERO;
+        return *this;
+    }
+    base_t * p = data.data();
+    size_t m = n-index;
+    if (shift) {
+        for (size_t i=0; i+1<m; ++i)
+            p[i] = (p[i+index]>>shift) | (p[i+index+1]<<(base_int-shift));
+        p[m-1] = p[n-1]>>shift;
+    }
+    else {
+        for (size_t i=0; i<m; ++i)
+            p[i] = p[i+index];
+    }
+    data.resize(m);
+    trim();
+    if (data.size()==1 && data[0]==0)
+        is_negative = false;
+    return *this;
 }
 
 /**
@@ -161,24 +275,47 @@ BigInteger BigInteger::subtract(const BigInteger & val) {
 BigInteger BigInteger::multiply(const BigInteger & val) const {
     if (equals(ZERO) || val.equals(ZERO))
         return ZERO;
+    if (this == &val)    // 自乘直接按平方计算
+        return square();
     // 将位数少的作为乘数
     const BigInteger & big = data.size()>val.data.size() ? (*this) : val;
     const BigInteger & small = (&big)==(this) ? val : (*this);
 
     BigInteger ans;
-    bit t(small);    // 转换为二进制进行运算
-
-    for (int i=t.size()-1; i>=0; --i)
-        if (t.at(i)) {
-            BigInteger temp(big);
-            temp.is_negative = false;
-            temp = temp.shiftLeft(i);    // 移位对齐
-            ans = ans.add(temp);
-        }
+    if (small.data.size()>=toom3_threshold && 2*small.data.size()>=big.data.size())// 两数都足够长,使用Toom-3
+        ans = mulToom3(big.abs(), small.abs());
+    else {
+        ans.data.resize(big.data.size()+small.data.size());
+        mulLimbs(big.data.data(), big.data.size(), small.data.data(), small.data.size(), ans.data.data());
+        ans.trim();
+    }
     ans.is_negative = !(is_negative == val.is_negative);
     return ans;
 }
 
+/**
+ * 函数功能:大整数平方运算,交叉项a[i]*a[j]只计算一次再翻倍,乘法次数约为multiply的一半
+ */
+BigInteger BigInteger::square() const {
+    if (equals(ZERO))
+        return ZERO;
+    BigInteger ans;
+    const size_t n = data.size();
+    if (n >= toom3_threshold) {
+        const BigInteger a = abs();
+        ans = mulToom3(a, a);
+    }
+    else {
+        ans.data.resize(2*n);
+        if (n < karatsuba_sqr_threshold)
+            sqrSchoolbook(data.data(), n, ans.data.data());
+        else
+            sqrKaratsuba(data.data(), n, ans.data.data());
+        ans.trim();
+    }
+    return ans;
+}
+
 /**
  * 函数功能:大整数整除运算
  * 参数含义:val代表除数
@@ -206,7 +343,26 @@ BigInteger BigInteger::remainder(const BigInteger & val) {
 BigInteger BigInteger::mod(const BigInteger & m) {
     BigInteger ans = remainder(m);
     if (ans.is_negative)
-        ans = ans.add(m);
+        ans += m;
+    return ans;
+}
+
+/**
+ * 函数功能:利用预先计算的Barrett上下文取模,结果与mod(red.modulus())相同
+ * 参数含义:red代表模数的Barrett上下文
+ */
+BigInteger BigInteger::mod(const Barrett & red) const {
+    return red.reduce(*this);
+}
+
+/**
+ * 函数功能:求a*b mod n,a、b的绝对值都小于n时乘积不超过2k位,约减不需要长除法
+ * 参数含义:a、b代表乘数,red代表模数n的Barrett上下文
+ */
+BigInteger BigInteger::mulMod(const BigInteger & a, const BigInteger & b, const Barrett & red) {
+    BigInteger ans(a);
+    ans *= b;
+    red.reduceInPlace(ans);
     return ans;
 }
 
@@ -214,47 +370,31 @@ BigInteger BigInteger::mod(const BigInteger & m) {
  * 函数功能:大整数整除运算和取余运算,整除结果直接返回,取余结果由m传回
  * 参数含义:val表示除数,m表示取余结果
  */
-BigInteger BigInteger::divideAndRemainder(const BigInteger & val, BigInteger & m) {
+BigInteger BigInteger::divideAndRemainder(const BigInteger & val, BigInteger & m) const {
     assert(!val.equals(ZERO));
-    BigInteger a = abs();
-    BigInteger b = val.abs();
-    int flag = a.compareTo(b);
-    if (flag == 0)// 绝对值相等
-        return (is_negative==val.is_negative) ? BigInteger(1) : BigInteger(-1);
-    if (flag == -1) {
+    // m可能与*this或val为同一对象,先记下符号
+    const bool quotient_negative = !(is_negative==val.is_negative);
+    const bool remainder_negative = is_negative;
+    if (abs().compareTo(val.abs()) == -1) {    // 被除数绝对值较小,商为0
         m = *this;
         return ZERO;
     }
-    BigInteger ans;
-
-    bit bit_b(b);
-    // 位数对齐
-    while (true) {// a的绝对值大于b的绝对值
-        bit bit_a(a);
-        int len = bit_a.size()-bit_b.size();
-        BigInteger temp;
-        // 找到移位
-        while (len >= 0) {
-            temp = b.shiftLeft(len);
-            if (temp.compareTo(a) != 1)// 找到最大的左移位数使得当前的a大于等于b
-                break;
-            --len;
-        }
-        if (len < 0)    // 当前的a小于b了
-            break;
-        base_t num = 0;
-        while (temp.compareTo(a) != 1) {
-            a = a.subtract(temp);
-            ++num;    // 统计当前的a最多大于等于几个移位后的b
-        }
-        temp = BigInteger(num);
-        if (len)
-            temp = temp.shiftLeft(len);// 移位后表明当前的a是b的几倍
-        ans = ans.add(temp);
-    }
-    ans.is_negative = !(is_negative==val.is_negative);
-    m.data = a.data;
-    m.is_negative = is_negative;
+    size_t na = data.size(), nb = val.data.size();
+    BigInteger ans, rem;
+    ans.data.assign(na-nb+1, 0);
+    if (nb == 1) {    // 除数只有一位,逐位试商即可
+        base_t r = divLimbs(ans.data.data(), data.data(), na, val.data[0]);
+        rem = fromLimbs(&r, 1);
+    }
+    else {
+        rem.data.resize(nb);
+        divKnuth(data.data(), na, val.data.data(), nb, ans.data.data(), rem.data.data());
+        rem.trim();
+    }
+    ans.trim();
+    ans.is_negative = quotient_negative && !ans.equals(ZERO);
+    rem.is_negative = remainder_negative && !rem.equals(ZERO);
+    m = std::move(rem);
     return ans;
 }
 
@@ -263,14 +403,7 @@ BigInteger BigInteger::divideAndRemainder(const BigInteger & val, BigInteger & m
  * 参数含义:exponent代表指数
  */
 BigInteger BigInteger::pow(const BigInteger & exponent) {
-    BigInteger ans(1);
-    bit t(exponent);    // 转化为二进制,快速求幂
-    for (int i=t.size()-1; i>=0; --i) {
-        ans = ans.multiply(ans);
-        if (t.at(i))
-            ans = multiply(ans);// 从高位开始,位权累加效应
-    }
-    return ans;
+    return windowPow(*this, exponent, nullptr);
 }
 
 /**
@@ -279,18 +412,15 @@ BigInteger BigInteger::pow(const BigInteger & exponent) {
  */
 BigInteger BigInteger::modPow(const BigInteger & exponent, const BigInteger & m) const {
     assert(!m.equals(ZERO));
-    BigInteger ans(1);
-    bit t(exponent);
-    for (int i=t.size()-1; i>=0; --i) {
-        ans = ans.multiply(ans).mod(m);
-        if (t.at(i))
-            ans = multiply(ans).mod(m);
-    }
-    return ans;
+    if ((m.data[0]&1) && m.abs().compareTo(ONE)==1)// 奇数模数使用蒙哥马利模乘,避免每步都做除法
+        return Montgomery(m).modPow(*this, exponent);
+    const Barrett red(m.abs());    // 偶数模数每步都要取模,用Barrett约减代替长除法
+    return windowPow(*this, exponent, &red);
 }
 
 /**
- * 函数功能:扩展欧几里得算法求乘法逆元
+ * 函数功能:Lehmer扩展欧几里得算法求乘法逆元。每一轮只用两数最高的62位估计接下来的
+ *          若干个商,把它们合成一个2x2的矩阵后一次作用到大整数上,估计不出商时才做一次完整的除法
  * 参数含义:m代表求逆元时的模数
  */
 BigInteger BigInteger::modInverse(const BigInteger & m) {
@@ -298,59 +428,134 @@ BigInteger BigInteger::modInverse(const BigInteger & m) {
     assert(!m.is_negative);    // m为正数
     if (equals(ZERO) || m.equals(ZERO))
         return ZERO;    // 有一个数为0,就不存在乘法逆元
-    BigInteger a[3], b[3], t[3];
-    // 以下进行初等变换
-    a[0] = 0; a[1] = 1; a[2] = *this;
-    b[0] = 1; b[1] = 0; b[2] = m;
-
-    for (t[2]=a[2].mod(b[2]); !t[2].equals(ZERO); t[2]=a[2].mod(b[2])) {
-        BigInteger temp = a[2].divide(b[2]);
-        for (int i=0; i<3; ++i) {
-            t[i] = a[i].subtract(temp.multiply(b[i]));// 不超过一次a[2]-temp*b[2]就变为大数减小数
-            a[i] = b[i];
-            b[i] = t[i];
+    // 始终保持a≡ua*this,b≡ub*this (mod m),且a>=b
+    BigInteger a(m), b(*this), ua, ub(1), q, r;
+    b %= m;
+    while (!b.equals(ZERO)) {
+        // Knuth算法L:ah、bh为a、b右移相同位数后的近似值,矩阵[A B; C D]记录已确定的商
+        const size_t bits = a.bitLength();
+        const size_t shift = bits>62 ? bits-62 : 0;
+        long_t ah = (long_t)a.wordAt(shift), bh = (long_t)b.wordAt(shift);
+        long_t A = 1, B = 0, C = 0, D = 1;
+        while (bh+C != 0 && bh+D != 0) {
+            long_t k = (ah+A)/(bh+C);
+            if (k != (ah+B)/(bh+D))    // 近似值已无法确定商
+                break;
+            long_t t = A-k*C; A = C; C = t;
+            t = B-k*D; B = D; D = t;
+            t = ah-k*bh; ah = bh; bh = t;
+        }
+        if (B == 0) {    // 一个商也没有确定,做一次完整的除法
+            q = a.divideAndRemainder(b, r);
+            a = std::move(b);
+            b = std::move(r);
+            ua -= q*ub;
+            std::swap(ua, ub);
+        }
+        else {    // (a,b)=(A*a+B*b, C*a+D*b),系数同样变换
+            BigInteger na = a*BigInteger(A), nb = a*BigInteger(C);
+            na += b*BigInteger(B);
+            nb += b*BigInteger(D);
+            a = std::move(na);
+            b = std::move(nb);
+            na = ua*BigInteger(A);
+            nb = ua*BigInteger(C);
+            na += ub*BigInteger(B);
+            nb += ub*BigInteger(D);
+            ua = std::move(na);
+            ub = std::move(nb);
         }
     }
-    if (b[2].equals(ONE)) {// 最大公约数为1,存在乘法逆元
-        if (b[1].is_negative)// 逆元为负数
-            b[1] = b[1].add(m);// 变为正数,使其在m的剩余集中
-        return b[1];
+    if (a.equals(ONE)) {// 最大公约数为1,存在乘法逆元
+        ua %= m;
+        if (ua.is_negative)// 逆元为负数
+            ua += m;// 变为正数,使其在m的剩余集中
+        return ua;
     }
     return ZERO;// 最大公约数不为1,无乘法逆元
 }
 
+/**
+ * 函数功能:常数时间的二进制扩展欧几里得算法求乘法逆元。迭代次数只取决于两数的位数,
+ *          每一轮都执行相同的按位运算,由掩码选择结果,不因数值不同而走不同的分支,
+ *          用于求私钥指数等需要防范计时攻击的场合
+ * 参数含义:m代表模数,要求0<*this<m且两者至少有一个为奇数
+ */
+BigInteger BigInteger::modInverseConstTime(const BigInteger & m) const {
+    assert(!is_negative && !m.is_negative);
+    assert(compareTo(m) == -1);
+    if (equals(ZERO) || !((data[0]|m.data[0]) & 1))
+        return ZERO;    // 为0或同为偶数,不存在乘法逆元
+    // 始终保持A*a-B*m=u,D*m-C*a=v,其中0<=A,C<m,0<=B,D<a
+    const size_t na = data.size(), nm = m.data.size();
+    const base_t * pa = data.data(), * pm = m.data.data();
+    ScratchBuffer<base_t> u(nm), v(pm, pm+nm), A(nm), C(nm), B(na), D(na), t(nm), t2(nm);
+    std::copy(pa, pa+na, u.begin());
+    A[0] = 1;
+    D[0] = 1;
+    const size_t iterations = (na+nm)*base_int;    // 每一轮至少有一个数减少一位
+    for (size_t it=0; it<iterations; ++it) {
+        // u、v都为奇数时用大的减去小的,对应的系数相加
+        const base_t both_odd = (base_t)0-(u[0] & v[0] & 1);
+        const base_t v_less_u = (base_t)0-subLimbs(t.data(), v.data(), nm, u.data(), nm);
+        selectLimbs(both_odd & ~v_less_u, v.data(), t.data(), v.data(), nm);
+        subLimbs(t.data(), u.data(), nm, v.data(), nm);
+        selectLimbs(both_odd & v_less_u, u.data(), t.data(), u.data(), nm);
+
+        base_t carry = addLimbs(t.data(), A.data(), nm, C.data(), nm);    // (A+C) mod m
+        carry -= subLimbs(t2.data(), t.data(), nm, pm, nm);
+        selectLimbs((base_t)0-(carry & 1), t.data(), t.data(), t2.data(), nm);
+        selectLimbs(both_odd & v_less_u, A.data(), t.data(), A.data(), nm);
+        selectLimbs(both_odd & ~v_less_u, C.data(), t.data(), C.data(), nm);
+        carry = addLimbs(t.data(), B.data(), na, D.data(), na);    // (B+D) mod a
+        carry -= subLimbs(t2.data(), t.data(), na, pa, na);
+        selectLimbs((base_t)0-(carry & 1), t.data(), t.data(), t2.data(), na);
+        selectLimbs(both_odd & v_less_u, B.data(), t.data(), B.data(), na);
+        selectLimbs(both_odd & ~v_less_u, D.data(), t.data(), D.data(), na);
+
+        // 此时u、v恰有一个为偶数,将其减半;系数不能整除2时先加上(m,a)
+        const base_t u_even = (u[0] & 1)-(base_t)1;
+        const base_t v_even = (v[0] & 1)-(base_t)1;
+        maskedHalveLimbs(u_even, u.data(), nm, 0, t.data());
+        base_t odd = (base_t)0-((A[0] | B[0]) & 1);
+        base_t carry_a = maskedAddLimbs(u_even & odd, A.data(), pm, nm, t.data());
+        base_t carry_b = maskedAddLimbs(u_even & odd, B.data(), pa, na, t.data());
+        maskedHalveLimbs(u_even, A.data(), nm, carry_a, t.data());
+        maskedHalveLimbs(u_even, B.data(), na, carry_b, t.data());
+
+        maskedHalveLimbs(v_even, v.data(), nm, 0, t.data());
+        odd = (base_t)0-((C[0] | D[0]) & 1);
+        base_t carry_c = maskedAddLimbs(v_even & odd, C.data(), pm, nm, t.data());
+        base_t carry_d = maskedAddLimbs(v_even & odd, D.data(), pa, na, t.data());
+        maskedHalveLimbs(v_even, C.data(), nm, carry_c, t.data());
+        maskedHalveLimbs(v_even, D.data(), na, carry_d, t.data());
+    }
+    // 结束时v为0,u为最大公约数;是否存在逆元不属于需要保密的信息
+    BigInteger g = fromLimbs(u.data(), nm);
+    if (!g.equals(ONE))
+        return ZERO;
+    return fromLimbs(A.data(), nm);
+}
+
+/**
+ * 函数功能:求大整数的绝对值除以单个位的数的余数,不产生商
+ * 参数含义:d代表除数
+ */
+BigInteger::base_t BigInteger::modWord(base_t d) const {
+    assert(d != 0);
+    dbl_t rem = 0;
+    for (size_t i=data.size(); i-->0; )
+        rem = ((rem<<base_int) | data[i]) % d;
+    return (base_t)rem;
+}
+
 /**
  * 函数功能:移位运算,左移
  * 参数含义:len代表移位的位数
  */
 BigInteger BigInteger::shiftLeft(const unsigned len) {
-    int index = len>>base_bit;    // 大整数每一位需要移动多少位
-    int shift = len&base_temp;    // 还剩下多少位
     BigInteger ans(*this);
-
-    int inc = (shift==0) ? index : index+1;// 有多余的位要多开大整数的一位
-    for (int i=0; i<inc; ++i)
-        ans.data.push_back(0);    // 高位补0
-
-    if (index) {
-        inc = (shift==0) ? 1 : 2;// 有多余的位要预留一位
-        for (int i=ans.data.size()-inc; i>=index; --i)
-            ans.data[i] = ans.data[i-index];
-        for (int i=0; i<index; ++i)
-            ans.data[i] = 0;
-    }
-    if (shift) {
-        base_t t = base_num;
-        t <<= base_int-shift;    // 用于截取高位
-        // 左移
-        base_t temp = 0;
-        for (size_t i=0; i<ans.data.size(); ++i) {
-            base_t tmp = ans.data[i];
-            ans.data[i] = (tmp<<shift) | temp;// 左移后加上大整数低位的高位
-            temp = (tmp&t)>>(base_int-shift);// 获取该大整数位的高位
-        }
-    }
-    ans = ans.trim();
+    ans <<= len;
     return ans;
 }
 
@@ -359,31 +564,8 @@ BigInteger BigInteger::shiftLeft(const unsigned len) {
  * 参数含义:len代表移位的位数
  */
 BigInteger BigInteger::shiftRight(const unsigned len) {
-    bit val(*this);
-    if (len >= val.size())// 当前大整数位数小于等于移位位数,返回0
-        return ZERO;
-    int index = len>>base_bit;// 大整数每一位需要移动多少位
-    int shift = len&base_temp;// 还剩下多少位
     BigInteger ans(*this);
-
-    if (index) {
-        for (int i=0; i<index; ++i)
-            ans.data[i] = ans.data[i+index];
-        for (int i=0; i<index; ++i)
-            ans.data.pop_back();    // 高位删除
-    }
-    if (shift) {
-        base_t t = base_num;
-        t >>= base_int-shift;    // 用于截取低位
-        // 右移
-        base_t temp = 0;
-        for (int i=ans.data.size()-1; i>=0; --i) {
-            base_t tmp = ans.data[i];
-            ans.data[i] = (tmp>>shift) | temp;// 右移后加上大整数高位的低位
-            temp = (tmp&t)<<(base_int-shift);// 获取该大整数位的低位
-        }
-    }
-    ans = ans.trim();
+    ans >>= len;
     return ans;
 }
 
@@ -397,18 +579,7 @@ int BigInteger::compareTo(const BigInteger & val) const {
             return -1;
         return 1;
     }
-    int flag = 0;
-    if (data.size() < val.data.size())// 位数较小
-        flag = -1;
-    else if (data.size() > val.data.size())// 位数较大
-        flag = 1;
-    else {    // 位数相等,从高位开始一一比较
-        for (std::vector<base_t>::const_reverse_iterator it=data.rbegin(), ite=val.data.rbegin(); it!=data.rend(); ++it, ++ite)
-            if ((*it) != (*ite)) {
-                flag = (*it)<(*ite) ? -1 : 1;    // 高位小,则小
-                break;
-            }
-    }
+    int flag = compareAbs(val);
     if (is_negative)    // 如为负数,小的反而大
         flag = -flag;
     return flag;
@@ -434,30 +605,111 @@ BigInteger BigInteger::valueOf(const long_t & num) {
  * 函数功能:将大整数转换为十六进制字符串并返回
  */
 std::string BigInteger::toString() const {
-    std::string ans;
-    base_t t = base_num;
-    t <<= base_int-4;    // 用于截取高4位
-    for (int i=data.size()-1; i>=0; --i) {
-        base_t temp = data[i];
-        for (int j=0; j<base_char; ++j) {
-            base_t num = t&temp;// 每次截取高4位
-            num >>= base_int-4;    // 将高4位移到低4位
-            temp <<= 4;
-            if (num < 10)
-                ans.push_back((char)('0'+num));
-            else
-                ans.push_back((char)('A'+num-10));
+    const char * pairs = hexPairs();
+    const size_t n = data.size()*base_char;
+    std::string ans(n+1, '0');    // 首位预留给负号
+    // 第i位对应字符串中的[n-(i+1)*base_char+1, n-i*base_char+1),每次查表写出一个字节的两个字符
+    for (size_t i=0; i<data.size(); ++i) {
+        base_t t = data[i];
+        char * q = &ans[n-i*base_char+1];
+        for (int j=0; j<base_char/2; ++j, t>>=8) {
+            q -= 2;
+            std::memcpy(q, pairs+2*(t&0xff), 2);
         }
     }
-    while (ans.size()>0 && ans.at(0)=='0')// 去掉高位无用的0
-        ans = ans.substr(1);
-    if (ans.empty())    // 空串说明为0
-        ans.push_back('0');
+    size_t pos = ans.find_first_not_of('0', 1);// 去掉高位无用的0
+    if (pos == std::string::npos)    // 全为0
+        return "0";
     if (is_negative)    // 为负数加上负号
-        ans = "-"+ans;
+        ans[--pos] = '-';
+    ans.erase(0, pos);
+    return ans;
+}
+
+/**
+ * 函数功能:由十进制字符串构造大整数,采用分治法:高半部分乘以10的幂再加上低半部分,
+ *          配合Karatsuba/Toom-3乘法,总的代价低于逐位乘10
+ * 参数含义:str代表十进制字符串,可以带负号
+ */
+BigInteger BigInteger::fromDecimal(const std::string & str) {
+    size_t begin = (!str.empty() && str[0]=='-') ? 1 : 0;
+    const size_t len = str.size()-begin;
+    if (len == 0)
+        return ZERO;
+    // pw[k]=dec_base^(2^k),即10^(dec_digits*2^k)
+    std::vector<BigInteger> pw(1, BigInteger());
+    pw[0].data[0] = dec_base;
+    while (((size_t)dec_digits<<pw.size()) < len)    // 低半部分的长度dec_digits*2^k总小于len
+        pw.push_back(pw.back()*pw.back());
+    BigInteger ans = fromDecimalRec(str.data()+begin, len, pw);
+    ans.is_negative = begin==1 && !ans.equals(ZERO);
     return ans;
 }
 
+/**
+ * 函数功能:将大整数转换为十进制字符串。以dec_base^(2^k)为除数把数一分为二,
+ *          两半分别递归转换,较小的数直接逐位除以dec_base
+ */
+std::string BigInteger::toDecimal() const {
+    BigInteger x = abs();
+    // 找到k使x<dec_base^(2^k),递归只用到k-1及以下的幂
+    std::vector<BigInteger> pw(1, BigInteger());
+    pw[0].data[0] = dec_base;
+    size_t k = 0;
+    while (true) {
+        if (x.compareAbs(pw.back()) < 0) {
+            k = pw.size()-1;
+            break;
+        }
+        if (2*pw.back().bitLength()-1 > x.bitLength()) {    // 平方必然大于x,不必真的求出
+            k = pw.size();
+            break;
+        }
+        pw.push_back(pw.back()*pw.back());
+    }
+    std::string ans(((size_t)dec_digits<<k)+1, '0');    // 首位预留给负号
+    toDecimalRec(x, k, pw, &ans[1]);
+    size_t pos = ans.find_first_not_of('0', 1);
+    if (pos == std::string::npos)
+        return "0";
+    if (is_negative)
+        ans[--pos] = '-';
+    ans.erase(0, pos);
+    return ans;
+}
+
+/**
+ * 函数功能:由字节序列构造一个非负大整数
+ * 参数含义:bytes代表字节序列,len代表字节数,little_endian为真时低位字节在前,否则高位字节在前
+ */
+BigInteger BigInteger::fromBytes(const unsigned char * bytes, size_t len, bool little_endian) {
+    const size_t per = base_int/8;    // 大整数一位对应的字节数
+    BigInteger ans;
+    ans.data.assign(std::max<size_t>((len+per-1)/per, 1), 0);    // 空序列对应0
+    for (size_t i=0; i<len; ++i) {    // 第i个字节(从低位数起)位于第i/per位
+        unsigned char b = bytes[little_endian ? i : len-1-i];
+        ans.data[i/per] |= (base_t)b << (8*(i%per));
+    }
+    ans.trim();
+    return ans;
+}
+
+/**
+ * 函数功能:将绝对值写成len个字节,不足时高位补0,超出的高位字节舍去
+ * 参数含义:bytes代表输出位置,len代表字节数,little_endian为真时低位字节在前,否则高位字节在前
+ */
+void BigInteger::toBytes(unsigned char * bytes, size_t len, bool little_endian) const {
+    const size_t per = base_int/8;
+    size_t i = 0;    // 从低位数起的字节序号
+    for (size_t k=0; k<data.size() && i<len; ++k) {
+        base_t t = data[k];
+        for (size_t j=0; j<per && i<len; ++j, ++i, t>>=8)
+            bytes[little_endian ? i : len-1-i] = (unsigned char)t;
+    }
+    for (; i<len; ++i)
+        bytes[little_endian ? i : len-1-i] = 0;
+}
+
 /**
  * 函数功能:返回大整数的绝对值
  */
@@ -471,12 +723,14 @@ BigInteger BigInteger::abs() const {
 // 大整数类型像使用基本类型一样,不一一介绍
 BigInteger operator + (const BigInteger & a, const BigInteger & b) {
     BigInteger t(a);
-    return t.add(b);
+    t += b;
+    return t;
 }
 
 BigInteger operator - (const BigInteger & a, const BigInteger & b) {
     BigInteger t(a);
-    return t.subtract(b);
+    t -= b;
+    return t;
 }
 
 BigInteger operator * (const BigInteger & a, const BigInteger & b) {
@@ -568,37 +822,565 @@ std::ostream & operator << (std::ostream & out, const BigInteger & val) {
 }
 
 /**
- * 函数功能:创建该大整数的一个副本,去除掉高位无用的0后并返回
+ * 函数功能:去除掉该大整数高位无用的0,直接修改当前大整数并返回其引用
+ */
+BigInteger & BigInteger::trim() {
+    size_t n = data.size();
+    while (n>1 && data[n-1]==0)    // 只有零的情况保留一位
+        --n;
+    data.resize(n);
+    return *this;
+}
+
+/**
+ * 函数功能:比较两个大整数的绝对值,-1表示本大整数要小,0表示相等,1表示本大整数要大
+ * 参数含义:val代表要与之比较的大整数
+ */
+int BigInteger::compareAbs(const BigInteger & val) const {
+    if (data.size() != val.data.size())    // 位数不同,位数多的大
+        return data.size()<val.data.size() ? -1 : 1;
+    for (size_t i=data.size(); i-->0; )    // 位数相等,从高位开始一一比较
+        if (data[i] != val.data[i])
+            return data[i]<val.data[i] ? -1 : 1;    // 高位小,则小
+    return 0;
+}
+
+/**
+ * 函数功能:返回绝对值的二进制位数,0的位数为0
+ */
+size_t BigInteger::bitLength() const {
+    size_t ans = (data.size()-1)*base_int;
+    for (base_t t=data.back(); t; t>>=1)
+        ++ans;
+    return ans;
+}
+
+/**
+ * 函数功能:返回绝对值右移shift位后的低64位,与每位的宽度无关
+ * 参数含义:shift代表右移的位数
  */
-BigInteger BigInteger::trim() {
-    size_t cnt = 0;
-    // 检查高位为0的元素的数量
-    for (std::vector<base_t>::const_reverse_iterator it=data.rbegin(); it!=data.rend(); ++it) {
-        if ((*it) == 0)
-            ++cnt;
+unsigned long long BigInteger::wordAt(size_t shift) const {
+    unsigned long long ans = 0;
+    size_t i = shift>>base_bit;
+    int pos = -(int)(shift&base_temp);    // 第i位的最低位在结果中的位置
+    for (; i<data.size() && pos<64; ++i, pos+=base_int) {
+        if (pos < 0)
+            ans |= (unsigned long long)(data[i]>>(-pos));
         else
-            break;
+            ans |= (unsigned long long)data[i]<<pos;
     }
-    if (cnt == data.size())    // 只有零的情况保留
-        --cnt;
-    BigInteger ans(*this);
-    for (size_t i=0; i<cnt; ++i)
-        ans.data.pop_back();
     return ans;
 }
 
 /**
- * 函数功能:根据给定的字符确定它所对应的十进制数
- * 参数含义:ch代表给定的字符
+ * 函数功能:将给定数的绝对值加到当前大整数的绝对值上,符号不变
+ * 参数含义:val代表加数,可以是当前大整数本身
+ */
+void BigInteger::addAbs(const BigInteger & val) {
+    if (data.size() < val.data.size())    // 被加数位数少,高位补0
+        data.resize(val.data.size(), 0);
+    // val与当前大整数为同一对象时,resize不会改变位数,直接读取仍然正确
+    base_t carry = addLimbs(data.data(), data.data(), data.size(), val.data.data(), val.data.size());
+    if (carry)    // 还有进位
+        data.push_back(carry);
+}
+
+/**
+ * 函数功能:当前大整数的绝对值与给定数的绝对值相减,结果为差的绝对值,符号由调用者设置
+ * 参数含义:val代表减数,两者绝对值不能相等
+ */
+void BigInteger::subAbs(const BigInteger & val) {
+    if (compareAbs(val) == 1)    // 大数减小数,直接在原位上减
+        subLimbs(data.data(), data.data(), data.size(), val.data.data(), val.data.size());
+    else {    // 小数减大数,结果位数与val相同
+        size_t n = data.size();
+        data.resize(val.data.size(), 0);
+        // r=val-this,subLimbs逐位先读后写,r与第二个操作数为同一数组也不影响结果
+        subLimbs(data.data(), val.data.data(), val.data.size(), data.data(), n);
+    }
+    trim();
+}
+
+/**
+ * 函数功能:由给定的若干位构造一个非负大整数
+ * 参数含义:p代表数据首地址(低位在前),n代表位数
+ */
+BigInteger BigInteger::fromLimbs(const base_t *p, size_t n) {
+    BigInteger ans;
+    if (n) {
+        ans.data.assign(p, p+n);
+        ans.trim();
+    }
+    return ans;
+}
+
+/**
+ * 函数功能:计算r=a+b,要求na>=nb,r有na位且可与a为同一数组,返回最高位的进位
+ * 参数含义:r代表结果,a、b代表加数,na、nb代表对应的位数
+ */
+BigInteger::base_t BigInteger::addLimbs(base_t *r, const base_t *a, size_t na, const base_t *b, size_t nb) {
+    dbl_t carry = 0;
+    size_t i = 0;
+    for (; i<nb; ++i) {
+        carry += (dbl_t)a[i]+b[i];
+        r[i] = (base_t)carry;
+        carry >>= base_int;
+    }
+    for (; i<na; ++i) {
+        carry += a[i];
+        r[i] = (base_t)carry;
+        carry >>= base_int;
+    }
+    return (base_t)carry;
+}
+
+/**
+ * 函数功能:计算r=a-b,要求na>=nb,r有na位且可与a为同一数组,返回最高位的借位
+ * 参数含义:r代表结果,a代表被减数,b代表减数,na、nb代表对应的位数
+ */
+BigInteger::base_t BigInteger::subLimbs(base_t *r, const base_t *a, size_t na, const base_t *b, size_t nb) {
+    base_t borrow = 0;
+    size_t i = 0;
+    for (; i<nb; ++i) {
+        dbl_t diff = (dbl_t)a[i]-b[i]-borrow;
+        r[i] = (base_t)diff;
+        borrow = (base_t)(diff>>base_int) & 1;    // 结果为负时高位全为1
+    }
+    for (; i<na; ++i) {
+        dbl_t diff = (dbl_t)a[i]-borrow;
+        r[i] = (base_t)diff;
+        borrow = (base_t)(diff>>base_int) & 1;
+    }
+    return borrow;
+}
+
+/**
+ * 函数功能:计算q=a/d,q有n位且可与a为同一数组,返回余数
+ * 参数含义:q代表商,a代表被除数,n代表位数,d代表除数(单个位)
+ */
+BigInteger::base_t BigInteger::divLimbs(base_t *q, const base_t *a, size_t n, base_t d) {
+    dbl_t rem = 0;
+    for (size_t i=n; i-->0; ) {    // 从高位开始逐位试商
+        rem = (rem<<base_int) | a[i];
+        q[i] = (base_t)(rem/d);
+        rem %= d;
+    }
+    return (base_t)rem;
+}
+
+/**
+ * 函数功能:计算r=r*m+a,返回最高位的进位
+ * 参数含义:r代表n位的数组,m代表乘数,a代表加数
+ */
+BigInteger::base_t BigInteger::mulAddLimbs(base_t *r, size_t n, base_t m, base_t a) {
+    dbl_t carry = a;
+    for (size_t i=0; i<n; ++i) {
+        carry += (dbl_t)r[i]*m;
+        r[i] = (base_t)carry;
+        carry >>= base_int;
+    }
+    return (base_t)carry;
+}
+
+/**
+ * 函数功能:Knuth算法D,多位除以多位的长除法,q=u/v,r=u%v,要求nu>=nv>=2且v的最高位非0
+ * 参数含义:u代表被除数(nu位),v代表除数(nv位),q代表商(nu-nv+1位),r代表余数(nv位)
+ */
+void BigInteger::divKnuth(const base_t *u, size_t nu, const base_t *v, size_t nv, base_t *q, base_t *r) {
+    const base_t high = (base_t)1<<(base_int-1);
+    // 规格化:左移使除数最高位为1,此时由高两位估计的商最多偏大2
+    int shift = 0;
+    for (base_t top=v[nv-1]; !(top&high); top<<=1)
+        ++shift;
+    ScratchBuffer<base_t> vn(nv), un(nu+1);
+    for (size_t i=nv-1; i>0; --i)
+        vn[i] = shift ? (v[i]<<shift) | (v[i-1]>>(base_int-shift)) : v[i];
+    vn[0] = v[0]<<shift;
+    un[nu] = shift ? u[nu-1]>>(base_int-shift) : 0;
+    for (size_t i=nu-1; i>0; --i)
+        un[i] = shift ? (u[i]<<shift) | (u[i-1]>>(base_int-shift)) : u[i];
+    un[0] = u[0]<<shift;
+
+    const dbl_t b = (dbl_t)1<<base_int;
+    for (size_t j=nu-nv+1; j-->0; ) {
+        // 由被除数的高两位和除数的最高位估计商,再用除数的次高位修正
+        dbl_t num = ((dbl_t)un[j+nv]<<base_int) | un[j+nv-1];
+        dbl_t qhat = num/vn[nv-1];
+        dbl_t rhat = num%vn[nv-1];
+        while (qhat>=b || qhat*vn[nv-2]>((rhat<<base_int) | un[j+nv-2])) {
+            --qhat;
+            rhat += vn[nv-1];
+            if (rhat >= b)
+                break;
+        }
+        // un[j...j+nv]-=qhat*vn
+        dbl_t carry = 0;
+        base_t borrow = 0;
+        for (size_t i=0; i<nv; ++i) {
+            dbl_t p = qhat*vn[i]+carry;
+            carry = p>>base_int;
+            dbl_t diff = (dbl_t)un[i+j]-(base_t)p-borrow;
+            un[i+j] = (base_t)diff;
+            borrow = (base_t)(diff>>base_int) & 1;
+        }
+        dbl_t diff = (dbl_t)un[j+nv]-carry-borrow;
+        un[j+nv] = (base_t)diff;
+        q[j] = (base_t)qhat;
+        if (diff>>base_int) {    // 减成负数,说明商估计大了1,加回一次除数
+            --q[j];
+            un[j+nv] += addLimbs(un.data()+j, un.data()+j, nv, vn.data(), nv);
+        }
+    }
+    // 余数需要右移回去
+    for (size_t i=0; i<nv; ++i)
+        r[i] = shift ? (un[i]>>shift) | (un[i+1]<<(base_int-shift)) : un[i];
+}
+
+/**
+ * 函数功能:竖式乘法,r=a*b,r有na+nb位
+ * 参数含义:a、b代表乘数,na、nb代表对应的位数,r代表结果
+ */
+void BigInteger::mulSchoolbook(const base_t *a, size_t na, const base_t *b, size_t nb, base_t *r) {
+    std::fill(r, r+na+nb, 0);
+    for (size_t j=0; j<nb; ++j) {
+        dbl_t carry = 0;
+        const dbl_t bj = b[j];
+        for (size_t i=0; i<na; ++i) {    // a*b[j]累加到r[j...]上,乘积加两个位不会溢出两倍长度
+            carry += a[i]*bj+r[i+j];
+            r[i+j] = (base_t)carry;
+            carry >>= base_int;
+        }
+        r[j+na] = (base_t)carry;
+    }
+}
+
+/**
+ * 函数功能:Karatsuba乘法,r=a*b,a、b均为n位,r有2n位
+ * 参数含义:a、b代表乘数,n代表位数,r代表结果
  */
-int BigInteger::hexToNum(char ch) {
-    int ans = 0;
-    if (isdigit(ch))
-        ans = ch-'0';
-    else if (islower(ch))
-        ans = ch-'a'+10;
-    else
-        ans = ch-'A'+10;
+void BigInteger::mulKaratsuba(const base_t *a, const base_t *b, size_t n, base_t *r) {
+    if (n < karatsuba_threshold) {
+        mulSchoolbook(a, n, b, n, r);
+        return;
+    }
+    // a=a1*B^h+a0, b=b1*B^h+b0, 高半部分m位不少于低半部分h位
+    size_t h = n>>1, m = n-h;
+    mulKaratsuba(a, b, h, r);            // z0=a0*b0,存于r的低2h位
+    mulKaratsuba(a+h, b+h, m, r+2*h);    // z2=a1*b1,存于r的高2m位
+
+    // z1=(a0+a1)*(b0+b1)-z0-z2
+    ScratchBuffer<base_t> sa(m+1), sb(m+1), z1(2*m+2);
+    sa[m] = addLimbs(sa.data(), a+h, m, a, h);
+    sb[m] = addLimbs(sb.data(), b+h, m, b, h);
+    mulKaratsuba(sa.data(), sb.data(), m+1, z1.data());
+    subLimbs(z1.data(), z1.data(), z1.size(), r, 2*h);
+    subLimbs(z1.data(), z1.data(), z1.size(), r+2*h, 2*m);
+
+    // r+=z1*B^h,z1不超过2m+1位
+    size_t len = std::min(z1.size(), 2*n-h);
+    addLimbs(r+h, r+h, 2*n-h, z1.data(), len);
+}
+
+/**
+ * 函数功能:根据位数选择竖式乘法或Karatsuba乘法,r=a*b,要求na>=nb,r有na+nb位
+ * 参数含义:a、b代表乘数,na、nb代表对应的位数,r代表结果
+ */
+void BigInteger::mulLimbs(const base_t *a, size_t na, const base_t *b, size_t nb, base_t *r) {
+    if (nb < karatsuba_threshold) {
+        mulSchoolbook(a, na, b, nb, r);
+        return;
+    }
+    if (na == nb) {
+        mulKaratsuba(a, b, nb, r);
+        return;
+    }
+    // 长度不对称时,将a切成若干段nb位分别与b相乘后累加
+    std::fill(r, r+na+nb, 0);
+    ScratchBuffer<base_t> temp(2*nb);
+    for (size_t off=0; off<na; off+=nb) {
+        size_t len = std::min(nb, na-off);
+        if (len == nb)
+            mulKaratsuba(a+off, b, nb, temp.data());
+        else
+            mulLimbs(b, nb, a+off, len, temp.data());
+        addLimbs(r+off, r+off, na+nb-off, temp.data(), len+nb);
+    }
+}
+
+/**
+ * 函数功能:竖式平方,r=a*a,r有2n位。先累加i<j的交叉项,整体左移一位后再加上对角线上的平方项
+ * 参数含义:a代表底数,n代表位数,r代表结果
+ */
+void BigInteger::sqrSchoolbook(const base_t *a, size_t n, base_t *r) {
+    std::fill(r, r+2*n, 0);
+    for (size_t i=0; i+1<n; ++i) {
+        dbl_t carry = 0;
+        const dbl_t ai = a[i];
+        for (size_t j=i+1; j<n; ++j) {
+            carry += ai*a[j]+r[i+j];
+            r[i+j] = (base_t)carry;
+            carry >>= base_int;
+        }
+        r[i+n] = (base_t)carry;
+    }
+    // 交叉项之和小于a*a/2,翻倍后不会超出2n位
+    base_t top = 0;
+    for (size_t i=0; i<2*n; ++i) {
+        base_t t = r[i];
+        r[i] = (t<<1) | top;
+        top = t>>(base_int-1);
+    }
+    dbl_t carry = 0;
+    for (size_t i=0; i<n; ++i) {
+        const dbl_t sq = (dbl_t)a[i]*a[i];
+        carry += (dbl_t)r[2*i]+(base_t)sq;
+        r[2*i] = (base_t)carry;
+        carry >>= base_int;
+        carry += (dbl_t)r[2*i+1]+(base_t)(sq>>base_int);
+        r[2*i+1] = (base_t)carry;
+        carry >>= base_int;
+    }
+}
+
+/**
+ * 函数功能:Karatsuba平方,r=a*a,a为n位,r有2n位。z1=(a0+a1)^2-z0-z2,三次递归都是平方
+ * 参数含义:a代表底数,n代表位数,r代表结果
+ */
+void BigInteger::sqrKaratsuba(const base_t *a, size_t n, base_t *r) {
+    if (n < karatsuba_sqr_threshold) {
+        sqrSchoolbook(a, n, r);
+        return;
+    }
+    size_t h = n>>1, m = n-h;
+    sqrKaratsuba(a, h, r);            // z0=a0^2,存于r的低2h位
+    sqrKaratsuba(a+h, m, r+2*h);    // z2=a1^2,存于r的高2m位
+
+    ScratchBuffer<base_t> sa(m+1), z1(2*m+2);
+    sa[m] = addLimbs(sa.data(), a+h, m, a, h);
+    sqrKaratsuba(sa.data(), m+1, z1.data());
+    subLimbs(z1.data(), z1.data(), z1.size(), r, 2*h);
+    subLimbs(z1.data(), z1.data(), z1.size(), r+2*h, 2*m);
+
+    // r+=z1*B^h
+    size_t len = std::min(z1.size(), 2*n-h);
+    addLimbs(r+h, r+h, 2*n-h, z1.data(), len);
+}
+
+/**
+ * 函数功能:Toom-3乘法,将两个非负大整数各切分为三段,通过5个点的求值和插值得到乘积。
+ *          a与b为同一对象时只求一组值,5次逐点乘法都改为平方
+ * 参数含义:a、b代表乘数(非负)
+ */
+BigInteger BigInteger::mulToom3(const BigInteger & a, const BigInteger & b) {
+    size_t k = (std::max(a.data.size(), b.data.size())+2)/3;    // 每段的位数
+    BigInteger x[3], y[3];
+    for (size_t i=0; i<3; ++i) {
+        size_t lo = std::min(i*k, a.data.size()), hi = std::min(lo+k, a.data.size());
+        x[i] = fromLimbs(a.data.data()+lo, hi-lo);
+        lo = std::min(i*k, b.data.size()), hi = std::min(lo+k, b.data.size());
+        y[i] = fromLimbs(b.data.data()+lo, hi-lo);
+    }
+    // 在0,1,-1,-2,无穷远处求值
+    BigInteger p0 = x[0], p1 = x[0].add(x[2]), pm1 = p1.subtract(x[1]);
+    p1 = p1.add(x[1]);
+    BigInteger pm2 = pm1.add(x[2]).shiftLeft(1).subtract(x[0]);
+    BigInteger r0, r1, rm1, rm2, r4;
+    if (&a == &b) {
+        r0 = p0.square();
+        r1 = p1.square();
+        rm1 = pm1.square();
+        rm2 = pm2.square();
+        r4 = x[2].square();
+    }
+    else {
+        BigInteger q0 = y[0], q1 = y[0].add(y[2]), qm1 = q1.subtract(y[1]);
+        q1 = q1.add(y[1]);
+        BigInteger qm2 = qm1.add(y[2]).shiftLeft(1).subtract(y[0]);
+        r0 = p0.multiply(q0);
+        r1 = p1.multiply(q1);
+        rm1 = pm1.multiply(qm1);
+        rm2 = pm2.multiply(qm2);
+        r4 = x[2].multiply(y[2]);
+    }
+
+    // Bodrato插值序列,其中的除法均为整除
+    BigInteger r3 = rm2.subtract(r1);
+    divLimbs(r3.data.data(), r3.data.data(), r3.data.size(), 3);
+    r3.trim();
+    BigInteger t1 = r1.subtract(rm1).shiftRight(1);    // 移位只作用于绝对值,符号不变
+    BigInteger r2 = rm1.subtract(r0);
+    r3 = r2.subtract(r3).shiftRight(1).add(r4.shiftLeft(1));
+    r2 = r2.add(t1).subtract(r4);
+    t1 = t1.subtract(r3);
+
+    // 合并结果:r0+t1*B^k+r2*B^2k+r3*B^3k+r4*B^4k
+    unsigned shift = (unsigned)k*base_int;
+    BigInteger ans(std::move(r4));
+    ans <<= shift; ans += r3;
+    ans <<= shift; ans += r2;
+    ans <<= shift; ans += t1;
+    ans <<= shift; ans += r0;
+    return ans;
+}
+
+/**
+ * 函数功能:掩码为全1时r=a,为0时r=b,不产生与数值有关的分支
+ * 参数含义:mask代表掩码,r代表结果(可与a、b为同一数组),a、b代表候选数组,n代表位数
+ */
+void BigInteger::selectLimbs(base_t mask, base_t *r, const base_t *a, const base_t *b, size_t n) {
+    for (size_t i=0; i<n; ++i)
+        r[i] = (a[i] & mask) | (b[i] & ~mask);
+}
+
+/**
+ * 函数功能:掩码为全1时r+=a,返回进位;掩码为0时r不变,返回0
+ * 参数含义:mask代表掩码,r、a代表n位的数组,t为n位的临时空间
+ */
+BigInteger::base_t BigInteger::maskedAddLimbs(base_t mask, base_t *r, const base_t *a, size_t n, base_t *t) {
+    base_t carry = addLimbs(t, r, n, a, n);
+    selectLimbs(mask, r, t, r, n);
+    return carry & mask & 1;
+}
+
+/**
+ * 函数功能:掩码为全1时将carry作为最高位、r整体右移一位;掩码为0时r不变
+ * 参数含义:mask代表掩码,r代表n位的数组,carry代表移入最高位的二进制位,t为n位的临时空间
+ */
+void BigInteger::maskedHalveLimbs(base_t mask, base_t *r, size_t n, base_t carry, base_t *t) {
+    for (size_t i=0; i+1<n; ++i)
+        t[i] = (r[i]>>1) | (r[i+1]<<(base_int-1));
+    t[n-1] = (r[n-1]>>1) | (carry<<(base_int-1));
+    selectLimbs(mask, r, t, r, n);
+}
+
+/**
+ * 函数功能:将小于dec_base^(2^k)的非负大整数写成恰好dec_digits*2^k个十进制字符,高位补0
+ * 参数含义:x代表大整数,k代表层数,pw代表dec_base^(2^j)的表,out代表输出位置
+ */
+void BigInteger::toDecimalRec(const BigInteger & x, size_t k, const std::vector<BigInteger> & pw, char * out) {
+    const size_t width = (size_t)dec_digits<<k;
+    if (k==0 || x.data.size()<=dec_threshold) {    // 逐位除以dec_base,由低到高写出
+        ScratchBuffer<base_t> t(x.data.begin(), x.data.end());
+        size_t n = t.size();
+        for (size_t pos=width; pos>0 && n>0; pos-=dec_digits) {
+            base_t r = divLimbs(t.data(), t.data(), n, dec_base);
+            while (n>0 && t[n-1]==0)
+                --n;
+            for (int j=1; j<=dec_digits; ++j, r/=10)
+                out[pos-j] = (char)('0'+r%10);
+        }
+        return;
+    }
+    // x=q*dec_base^(2^(k-1))+r,q和r各占一半的字符
+    BigInteger q, r;
+    q = x.divideAndRemainder(pw[k-1], r);
+    toDecimalRec(q, k-1, pw, out);
+    toDecimalRec(r, k-1, pw, out+width/2);
+}
+
+/**
+ * 函数功能:将len个十进制字符转换为非负大整数
+ * 参数含义:p代表字符串首地址,len代表字符个数,pw代表dec_base^(2^j)的表
+ */
+BigInteger BigInteger::fromDecimalRec(const char * p, size_t len, const std::vector<BigInteger> & pw) {
+    if (len <= (size_t)dec_digits*dec_threshold) {    // 每次读入dec_digits个字符,乘以10的幂后累加
+        BigInteger ans;
+        size_t n = 1;
+        ans.data.resize((len+dec_digits-1)/dec_digits+1, 0);
+        for (size_t i=0; i<len; ) {
+            size_t cnt = (i==0 && len%dec_digits) ? len%dec_digits : dec_digits;
+            base_t m = 1, a = 0;
+            for (size_t j=0; j<cnt; ++j, ++i) {
+                m *= 10;
+                a = a*10+(base_t)(p[i]-'0');
+            }
+            base_t carry = mulAddLimbs(ans.data.data(), n, m, a);
+            if (carry)
+                ans.data[n++] = carry;
+        }
+        ans.data.resize(n);
+        ans.trim();
+        return ans;
+    }
+    // 低半部分取dec_digits*2^k个字符,结果为高半部分*dec_base^(2^k)+低半部分
+    size_t k = 0;
+    while (((size_t)dec_digits<<(k+1)) < len)
+        ++k;
+    const size_t lo = (size_t)dec_digits<<k;
+    BigInteger ans = fromDecimalRec(p, len-lo, pw)*pw[k];
+    ans += fromDecimalRec(p+len-lo, lo, pw);
+    return ans;
+}
+
+/**
+ * 函数功能:根据指数的二进制长度选择滑动窗口的大小,使预计算与乘法次数之和最少
+ * 参数含义:bits代表指数的二进制位数
+ */
+int BigInteger::windowBits(size_t bits) {
+    if (bits > 671) return 6;
+    if (bits > 239) return 5;
+    if (bits > 79) return 4;
+    if (bits > 23) return 3;
+    return 1;
+}
+
+/**
+ * 函数功能:滑动窗口法求幂,只需预先计算底数的奇数次幂,每个窗口只做一次乘法
+ * 参数含义:base代表底数,exponent代表指数,red代表模数的Barrett上下文(为空时不取模)
+ */
+BigInteger BigInteger::windowPow(const BigInteger & base, const BigInteger & exponent, const Barrett * red) {
+    BigInteger ans(1);
+    if (exponent.equals(ZERO))
+        return ans;
+    bit e(exponent);
+    const int k = windowBits(e.size());
+
+    // g[i]=base^(2i+1)
+    std::vector<BigInteger> g(1<<(k-1));
+    g[0] = red ? base.mod(*red) : base;
+    if (g.size() > 1) {
+        BigInteger sqr = g[0].square();
+        if (red)
+            red->reduceInPlace(sqr);
+        for (size_t i=1; i<g.size(); ++i) {
+            g[i] = g[i-1].multiply(sqr);
+            if (red)
+                red->reduceInPlace(g[i]);
+        }
+    }
+
+    bool started = false;    // 是否已乘入第一个窗口
+    for (int i=e.size()-1; i>=0; ) {
+        if (!e.at(i)) {    // 窗口外的0只需平方
+            ans = ans.square();
+            if (red)
+                red->reduceInPlace(ans);
+            --i;
+            continue;
+        }
+        // 找到以i开头、长度不超过k且以1结尾的最长窗口
+        int l = std::max(i-k+1, 0);
+        while (!e.at(l))
+            ++l;
+        base_t val = 0;
+        for (int j=i; j>=l; --j)
+            val = (val<<1) | (e.at(j) ? 1 : 0);
+        if (started) {
+            for (int j=i; j>=l; --j) {
+                ans = ans.square();
+                if (red)
+                    red->reduceInPlace(ans);
+            }
+            ans = ans.multiply(g[val>>1]);
+            if (red)
+                red->reduceInPlace(ans);
+        }
+        else {
+            ans = g[val>>1];
+            started = true;
+        }
+        i = l-1;
+    }
     return ans;
 }
 
@@ -609,10 +1391,10 @@ int BigInteger::hexToNum(char ch) {
 BigInteger::bit::bit(const BigInteger & val) {
     bit_vector = val.data;
     base_t temp = bit_vector[bit_vector.size()-1];// 大整数最高位
-    length = bit_vector.size()<<base_bit;    // 大整数一位占二进制32位
-    base_t t = 1<<(base_int-1);    // 用于截取一个数的二进制最高位
+    length = bit_vector.size()<<base_bit;    // 大整数一位占二进制base_int位
+    base_t t = (base_t)1<<(base_int-1);    // 用于截取一个数的二进制最高位
 
-    if (temp == 0)    // 大整数最高位为0,减去32
+    if (temp == 0)    // 大整数最高位为0,减去base_int
         length -= base_int;
     else {
         while (!(temp & t)) {// 从高位开始检测大整数的二进制位,为0长度减一
@@ -630,5 +1412,5 @@ bool BigInteger::bit::at(size_t id) {
     size_t index = id>>base_bit;// 确定其在大整数第几位
     size_t shift = id&base_temp;// 确定其在大整数那一位的二进制第几位
     base_t t = bit_vector[index];
-    return (t & (1<<shift));
+    return (t & ((base_t)1<<shift));
 }
@@ -3,27 +3,57 @@
 #include <string>
 #include <vector>
 #include <ostream>
+#include "InlineVector.h"
+
+class Barrett;
+
+// 编译器支持128位整数时使用64位的位宽,加减乘除的循环次数减半
+#if defined(__SIZEOF_INT128__) && !defined(BIGINTEGER_LIMB32)
+#define BIGINTEGER_LIMB64
+#endif
 
 class BigInteger {
 public:
     typedef long long long_t;
+#ifdef BIGINTEGER_LIMB64
+    typedef unsigned long long base_t;    // 每位64个二进制位
+    typedef unsigned __int128 dbl_t;    // 两倍于base_t的无符号类型,用于按位加减乘除的进位
+#else
     typedef unsigned base_t;
+    typedef unsigned long long dbl_t;    // 两倍于base_t的无符号类型,用于按位加减乘除的进位
+#endif
     BigInteger(): is_negative(false) { data.push_back(0); }// 默认为0
     BigInteger(const BigInteger &);    // 利用给定的大整数初始化
+    BigInteger(BigInteger &&) noexcept;    // 接管给定大整数的数据,不复制
     BigInteger(const std::string &);// 利用给定的十六进制字符串初始化
     BigInteger(const long_t &);        // 利用给定的long_t类型数据初始化
     ~BigInteger() {}
 
+    BigInteger & operator = (const BigInteger &);    // 复制赋值
+    BigInteger & operator = (BigInteger &&) noexcept;// 移动赋值
+    // 以下复合赋值运算直接在当前大整数上修改,尽量复用已有的存储空间
+    BigInteger & operator += (const BigInteger &);
+    BigInteger & operator -= (const BigInteger &);
+    BigInteger & operator *= (const BigInteger &);
+    BigInteger & operator %= (const BigInteger &);    // 取余,结果符号与被除数相同
+    BigInteger & operator <<= (const unsigned);    // 绝对值左移,符号不变
+    BigInteger & operator >>= (const unsigned);    // 绝对值右移,符号不变
+
     BigInteger add(const BigInteger &);        // 大整数加法
     BigInteger subtract(const BigInteger &);// 大整数减法
     BigInteger multiply(const BigInteger &) const;// 大整数乘法
+    BigInteger square() const;    // 大整数平方,交叉项只计算一次
     BigInteger divide(const BigInteger &);    // 大整数整除
     BigInteger remainder(const BigInteger &);    // 大整数取余
     BigInteger mod(const BigInteger &);        // 大整数取模
-    BigInteger divideAndRemainder(const BigInteger &, BigInteger &);// 大整数整除和取余
+    BigInteger mod(const Barrett &) const;    // 用预先计算的Barrett上下文取模
+    static BigInteger mulMod(const BigInteger &, const BigInteger &, const Barrett &);// 乘法后用Barrett约减
+    BigInteger divideAndRemainder(const BigInteger &, BigInteger &) const;// 大整数整除和取余
     BigInteger pow(const BigInteger &);        // 大整数幂乘
     BigInteger modPow(const BigInteger &, const BigInteger &) const;// 大整数幂模运算
-    BigInteger modInverse(const BigInteger &);// 用扩展欧几里得算法求乘法逆元
+    BigInteger modInverse(const BigInteger &);// 用Lehmer扩展欧几里得算法求乘法逆元
+    BigInteger modInverseConstTime(const BigInteger &) const;// 求乘法逆元,执行过程与数值无关,用于私钥
+    base_t modWord(base_t) const;    // 绝对值对单个位的数取余,用于小素数筛选
 
     BigInteger shiftLeft(const unsigned);    // 移位运算,左移
     BigInteger shiftRight(const unsigned);    // 移位运算,右移
@@ -32,6 +62,13 @@ public:
     bool equals(const BigInteger &) const;// 判断是否等于给定数
     static BigInteger valueOf(const long_t &);// 将给定数转换为大整数并返回
     std::string toString() const;    // 将大整数转换为十六进制字符串
+    static BigInteger fromDecimal(const std::string &);// 由十进制字符串构造大整数
+    std::string toDecimal() const;    // 将大整数转换为十进制字符串
+    // 由字节序列构造非负大整数,little_endian为真时低位字节在前
+    static BigInteger fromBytes(const unsigned char *, size_t, bool little_endian = false);
+    void toBytes(unsigned char *, size_t, bool little_endian = false) const;// 将绝对值写成定长字节序列
+    size_t bitLength() const;    // 绝对值的二进制位数
+    size_t byteLength() const { return (bitLength()+7)/8; }// 绝对值的字节数
     BigInteger abs() const;        // 求大整数的绝对值
 protected:
     // 以下运算符重载函数主要用于像基本类型一样使用大整数类型
@@ -64,21 +101,65 @@ protected:
     BigInteger operator = (const std::string & str) { return (*this) = BigInteger(str); }
     BigInteger operator = (const long_t & num) { return (*this) = BigInteger(num); }
 private:
-    BigInteger trim();    // 去掉高位无用的0
-    int hexToNum(char);    // 十六进制字符转换为十进制数
+    BigInteger & trim();    // 去掉高位无用的0
+    int compareAbs(const BigInteger &) const;    // 比较绝对值大小
+    unsigned long long wordAt(size_t) const;    // 绝对值右移给定位数后的低64位
+    void addAbs(const BigInteger &);    // 绝对值加上给定数的绝对值
+    void subAbs(const BigInteger &);    // 绝对值减去给定数的绝对值,结果取绝对值
+    static BigInteger fromLimbs(const base_t *, size_t);// 由给定的若干位(低位在前)构造大整数
+
+    // 以下为直接作用于数组(低位在前)的按位运算,供乘法、除法等核心算法使用
+    static base_t addLimbs(base_t *, const base_t *, size_t, const base_t *, size_t);// 加法,返回进位
+    static base_t subLimbs(base_t *, const base_t *, size_t, const base_t *, size_t);// 减法,返回借位
+    static base_t divLimbs(base_t *, const base_t *, size_t, base_t);// 除以单个位,返回余数
+    static base_t mulAddLimbs(base_t *, size_t, base_t, base_t);// 乘以单个位再加上单个位,返回进位
+    static void divKnuth(const base_t *, size_t, const base_t *, size_t, base_t *, base_t *);// 多位长除法
+    static void mulSchoolbook(const base_t *, size_t, const base_t *, size_t, base_t *);// 竖式乘法
+    static void mulKaratsuba(const base_t *, const base_t *, size_t, base_t *);// Karatsuba乘法
+    static void mulLimbs(const base_t *, size_t, const base_t *, size_t, base_t *);// 按长度选择乘法
+    static void sqrSchoolbook(const base_t *, size_t, base_t *);// 竖式平方
+    static void sqrKaratsuba(const base_t *, size_t, base_t *);// Karatsuba平方
+    static BigInteger mulToom3(const BigInteger &, const BigInteger &);// Toom-3乘法,两个参数为同一对象时按平方计算
+    static void selectLimbs(base_t, base_t *, const base_t *, const base_t *, size_t);// 按掩码选择,不产生分支
+    static base_t maskedAddLimbs(base_t, base_t *, const base_t *, size_t, base_t *);// 掩码为全1时相加
+    static void maskedHalveLimbs(base_t, base_t *, size_t, base_t, base_t *);// 掩码为全1时右移一位
+    static int windowBits(size_t);    // 根据指数的二进制长度选择滑动窗口大小
+    static BigInteger windowPow(const BigInteger &, const BigInteger &, const Barrett *);// 滑动窗口求幂
+    // 十进制转换的分治递归,第三个参数为预先计算的dec_base^(2^k)
+    static void toDecimalRec(const BigInteger &, size_t, const std::vector<BigInteger> &, char *);
+    static BigInteger fromDecimalRec(const char *, size_t, const std::vector<BigInteger> &);
 public:
+#ifdef BIGINTEGER_LIMB64
+    static const int base_bit = 6;    // 2^6=64,大整数每位存储的二进制位数
+    static const int base_char = 16;    // 组成大整数的一位需要的十六进制位数
+    static const int base_int = 64;    // 大整数一位对应的二进制位数
+    static const int base_temp = 0x3f;    // 截取模64的余数的辅助
+    static const size_t karatsuba_threshold = 24;// 位数不小于该值时使用Karatsuba乘法
+    static const size_t toom3_threshold = 192;    // 位数不小于该值时使用Toom-3乘法
+    static const size_t karatsuba_sqr_threshold = 48;// 位数不小于该值时使用Karatsuba平方
+    static const int dec_digits = 19;    // 大整数一位最多容纳的十进制位数
+    static const base_t dec_base = 10000000000000000000ULL;    // 10^dec_digits
+#else
     static const int base_bit = 5;    // 2^5=32,大整数每位存储的二进制位数
     static const int base_char = 8;    // 组成大整数的一位需要的十六进制位数
     static const int base_int = 32;    // 大整数一位对应的二进制位数
-    static const int base_num = 0xffffffff;// 截取低位的辅助
     static const int base_temp = 0x1f;    // 截取模32的余数的辅助
+    static const size_t karatsuba_threshold = 24;// 位数不小于该值时使用Karatsuba乘法
+    static const size_t toom3_threshold = 256;    // 位数不小于该值时使用Toom-3乘法
+    static const size_t karatsuba_sqr_threshold = 48;// 位数不小于该值时使用Karatsuba平方
+    static const int dec_digits = 9;    // 大整数一位最多容纳的十进制位数
+    static const base_t dec_base = 1000000000;    // 10^dec_digits
+#endif
+    static const base_t base_num = ~(base_t)0;// 截取低位的辅助
+    static const size_t dec_threshold = 32;    // 位数不超过该值时十进制转换直接逐位进行
     static const BigInteger ZERO;    // 大整数常量0
     static const BigInteger ONE;    // 大整数常量1
     static const BigInteger TWO;    // 大整数常量2
     static const BigInteger TEN;    // 大整数常量10
 private:
     bool is_negative;// 是否为负数
-    std::vector<base_t> data;// 按位数据存储,高位在后
+    static const size_t inline_limbs = 4096/base_int;    // 不超过4096位的数直接存放在对象内部
+    InlineVector<base_t, inline_limbs> data;// 按位数据存储,高位在后
     class bit {    // 便于大整数运算的二进制处理类
     public:
         bit(const BigInteger &);// 根据大整数初始化
@@ -86,10 +167,16 @@ private:
         size_t size() { return length; }    // 返回大整数对应的二进制位数
         bool at(size_t);    // 返回第i位二进制是否为1
     private:
-        std::vector<base_t> bit_vector;    // 二进制数据存储,每一个元素对应32位二进制
+        InlineVector<base_t, inline_limbs> bit_vector;    // 二进制数据存储,每一个元素对应base_int位二进制
         size_t length;    // 二进制的总位数
     };
     friend class RSA_Encryption;    // RSA_Encryption为其友元类
+    friend class RSA_Key;    // 密钥生成需要直接访问按位数据
+    friend class Montgomery;    // Montgomery需要直接按位运算
+    friend class FixedBaseComb;
+    friend class Barrett;    // Barrett约减直接截取低位相减
+    template <size_t> friend class FixedBigInt;    // 定长整数与大整数相互转换
+    template <size_t> friend class FixedMontgomery;
 };
 
 #endif // BIGINTEGER_H
@@ -0,0 +1,206 @@
+#include "ChaCha20.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+// RtlGenRandom,由advapi32导出,没有对应的头文件声明
+extern "C" BOOLEAN NTAPI SystemFunction036(PVOID buffer, ULONG length);
+#elif defined(__linux__) && defined(__has_include)
+#if __has_include(<sys/random.h>)
+#include <sys/random.h>
+#define CHACHA20_HAS_GETRANDOM
+#endif
+#endif
+
+namespace {
+inline uint32_t Rotl(uint32_t x, int n) { return (x<<n) | (x>>(32-n)); }
+
+inline void QuarterRound(uint32_t &a, uint32_t &b, uint32_t &c, uint32_t &d)
+{
+    a += b; d ^= a; d = Rotl(d, 16);
+    c += d; b ^= c; b = Rotl(b, 12);
+    a += b; d ^= a; d = Rotl(d, 8);
+    c += d; b ^= c; b = Rotl(b, 7);
+}
+
+// 按小端字节序写出一个字,保证不同平台的输出相同
+inline void StoreLE(unsigned char *out, uint32_t w)
+{
+    out[0] = (unsigned char)w;
+    out[1] = (unsigned char)(w>>8);
+    out[2] = (unsigned char)(w>>16);
+    out[3] = (unsigned char)(w>>24);
+}
+}
+
+/**
+ * 函数功能:从操作系统的密码学安全随机数源取256位密钥和流编号,取不到时IsSeeded()为false
+ */
+ChaCha20::ChaCha20(): counter(0), stream(0), used(sizeof(buffer))
+{
+    uint32_t seed[10];
+    seeded = SystemRandom(seed, sizeof(seed));
+    std::memcpy(key, seed, sizeof(key));
+    stream = ((uint64_t)seed[8]<<32) | seed[9];
+    std::memset(seed, 0, sizeof(seed));
+}
+
+/**
+ * 函数功能:读取操作系统的密码学安全随机数:Windows使用RtlGenRandom,Linux使用getrandom,
+ *          其他系统读/dev/urandom;都不可用时退回std::random_device,
+ *          但MinGW在GCC 9.2之前的random_device是固定种子的mt19937,此时直接失败
+ * 参数含义:out代表输出缓冲区,bytes代表字节数
+ */
+bool ChaCha20::SystemRandom(void *out, size_t bytes)
+{
+    unsigned char *p = static_cast<unsigned char*>(out);
+#if defined(_WIN32)
+    while (bytes > 0) {
+        const ULONG n = (ULONG)std::min<size_t>(bytes, 1u<<20);
+        if (!SystemFunction036(p, n))
+            break;
+        p += n;
+        bytes -= n;
+    }
+#elif defined(CHACHA20_HAS_GETRANDOM)
+    while (bytes > 0) {
+        const ssize_t n = getrandom(p, bytes, 0);
+        if (n <= 0)
+            break;
+        p += n;
+        bytes -= n;
+    }
+#endif
+    if (bytes > 0) {
+        if (std::FILE *device = std::fopen("/dev/urandom", "rb")) {
+            const size_t n = std::fread(p, 1, bytes, device);
+            std::fclose(device);
+            p += n;
+            bytes -= n;
+        }
+    }
+    if (bytes == 0)
+        return true;
+#if defined(__MINGW32__) && defined(__GLIBCXX__) && (__GNUC__ < 9 || (__GNUC__ == 9 && __GNUC_MINOR__ < 2))
+    return false;
+#else
+    std::random_device device;
+    for (; bytes > 0; ++p, --bytes)
+        *p = (unsigned char)device();
+    return true;
+#endif
+}
+
+/**
+ * 函数功能:由固定种子展开密钥,用于需要可复现结果的场合,不能用于真实的密钥
+ * 参数含义:seed代表种子,stream代表流编号
+ */
+ChaCha20::ChaCha20(uint64_t seed, uint64_t stream): counter(0), stream(stream), used(sizeof(buffer)), seeded(true)
+{
+    key[0] = (uint32_t)seed;
+    key[1] = (uint32_t)(seed>>32);
+    for (int i = 2; i < 8; ++i)
+        key[i] = 0;
+}
+
+/**
+ * 函数功能:ChaCha20分组函数,10轮双轮(列轮+对角线轮)后与初始状态相加
+ * 参数含义:key代表256位密钥,counter代表分组编号,stream代表流编号,out传回16个字
+ */
+void ChaCha20::Block(const uint32_t key[8], uint64_t counter, uint64_t stream, uint32_t out[16])
+{
+    const uint32_t in[16] = {
+        0x61707865, 0x3320646e, 0x79622d32, 0x6b206574,    // "expand 32-byte k"
+        key[0], key[1], key[2], key[3], key[4], key[5], key[6], key[7],
+        (uint32_t)counter, (uint32_t)(counter>>32), (uint32_t)stream, (uint32_t)(stream>>32)
+    };
+    uint32_t x[16];
+    std::memcpy(x, in, sizeof(x));
+    for (int i = 0; i < 10; ++i) {
+        QuarterRound(x[0], x[4], x[8], x[12]);
+        QuarterRound(x[1], x[5], x[9], x[13]);
+        QuarterRound(x[2], x[6], x[10], x[14]);
+        QuarterRound(x[3], x[7], x[11], x[15]);
+        QuarterRound(x[0], x[5], x[10], x[15]);
+        QuarterRound(x[1], x[6], x[11], x[12]);
+        QuarterRound(x[2], x[7], x[8], x[13]);
+        QuarterRound(x[3], x[4], x[9], x[14]);
+    }
+    for (int i = 0; i < 16; ++i)
+        out[i] = x[i]+in[i];
+}
+
+/**
+ * 函数功能:生成密钥流并与输入异或,完整的64字节分组按字处理,最后不足一组的按字节处理
+ * 参数含义:key代表密钥,stream代表流编号,counter代表起始分组编号,in、out代表输入输出,len代表字节数
+ */
+void ChaCha20::Crypt(const uint32_t key[8], uint64_t stream, uint64_t counter,
+                     const unsigned char *in, unsigned char *out, size_t len)
+{
+    uint32_t block[16];
+    unsigned char bytes[64];
+    for (; len > 0; ++counter) {
+        Block(key, counter, stream, block);
+        for (int i = 0; i < 16; ++i)
+            StoreLE(bytes+4*i, block[i]);
+        const size_t n = len < 64 ? len : 64;
+        for (size_t i = 0; i < n; ++i)
+            out[i] = in[i]^bytes[i];
+        in += n;
+        out += n;
+        len -= n;
+    }
+}
+
+void ChaCha20::LoadKey(const unsigned char bytes[32], uint32_t key[8])
+{
+    for (int i = 0; i < 8; ++i)
+        key[i] = (uint32_t)bytes[4*i] | ((uint32_t)bytes[4*i+1]<<8) | ((uint32_t)bytes[4*i+2]<<16)
+                | ((uint32_t)bytes[4*i+3]<<24);
+}
+
+void ChaCha20::Refill()
+{
+    Block(key, counter++, stream, buffer);
+    used = 0;
+}
+
+ChaCha20::result_type ChaCha20::operator()()
+{
+    used = (used+3) & ~(size_t)3;    // Fill可能留下不足一个字的零头
+    if (used+4 > sizeof(buffer))
+        Refill();
+    uint32_t ans = buffer[used/4];
+    used += 4;
+    return ans;
+}
+
+/**
+ * 函数功能:先用掉当前分组剩余的字节,之后整组直接写入输出,不经过缓冲区
+ * 参数含义:out代表输出缓冲区,bytes代表字节数
+ */
+void ChaCha20::Fill(void *out, size_t bytes)
+{
+    unsigned char *dst = static_cast<unsigned char*>(out);
+    // 当前分组剩余的字节
+    while (bytes && used < sizeof(buffer)) {
+        *dst++ = (unsigned char)(buffer[used/4]>>(8*(used%4)));
+        ++used;
+        --bytes;
+    }
+    uint32_t block[16];
+    for (; bytes >= sizeof(block); bytes -= sizeof(block), dst += sizeof(block)) {
+        Block(key, counter++, stream, block);
+        for (int i = 0; i < 16; ++i)
+            StoreLE(dst+4*i, block[i]);
+    }
+    if (bytes) {
+        Refill();
+        Fill(dst, bytes);
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef CHACHA20_H
+#define CHACHA20_H
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * 基于ChaCha20分组函数的密码学安全伪随机数生成器:256位密钥、64位计数器和64位流编号,
+ * 每次生成64字节。默认由操作系统的密码学安全随机数源播种,也可用固定种子得到可复现的序列(仅用于测试和基准)。
+ * 满足UniformRandomBitGenerator的要求,可直接交给标准库的分布使用
+ */
+class ChaCha20
+{
+public:
+    typedef uint32_t result_type;
+
+    ChaCha20();    // 由操作系统的密码学安全随机数源播种
+    explicit ChaCha20(uint64_t seed, uint64_t stream = 0);    // 固定种子,相同参数得到相同的序列
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return 0xFFFFFFFFu; }
+    result_type operator()();    // 返回下一个32位随机数
+    void Fill(void *out, size_t bytes);    // 用随机字节填满给定的缓冲区
+    // 是否取得了可靠的种子;为false时输出可以预测,不能用来生成密钥
+    bool IsSeeded() const { return seeded; }
+    // 从操作系统的密码学安全随机数源读取字节,没有可靠的来源时返回false
+    static bool SystemRandom(void *out, size_t bytes);
+
+    // ChaCha20分组函数,由密钥、计数器和流编号生成16个字
+    static void Block(const uint32_t key[8], uint64_t counter, uint64_t stream, uint32_t out[16]);
+    // 用作流密码:从第counter个分组开始的密钥流与in逐字节异或后写入out,in与out可以相同
+    static void Crypt(const uint32_t key[8], uint64_t stream, uint64_t counter,
+                      const unsigned char *in, unsigned char *out, size_t len);
+    // 把32字节的密钥按小端序转换为8个字
+    static void LoadKey(const unsigned char bytes[32], uint32_t key[8]);
+private:
+    uint32_t key[8];
+    uint64_t counter;    // 下一个分组的编号
+    uint64_t stream;    // 流编号,同一种子的不同流互不相关
+    uint32_t buffer[16];    // 当前分组
+    size_t used;    // 当前分组已用掉的字节数
+    bool seeded;    // 种子是否可靠
+
+    void Refill();    // 生成下一个分组
+};
+
+#endif // CHACHA20_H
@@ -0,0 +1,458 @@
+#ifndef FIXEDBIGINT_H
+#define FIXEDBIGINT_H
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include "BigInteger.h"
+
+namespace FixedDetail {
+
+// 将f(0),f(1),...,f(N-1)在编译期展开为顺序执行的N次调用
+template <typename F, size_t... I>
+inline void unroll(F && f, std::index_sequence<I...>) {
+    int expand[] = {0, (f(I), 0)...};
+    (void)expand;
+}
+
+}
+
+/**
+ * 函数功能:编译期展开长度为N的循环,循环体按下标从小到大依次执行
+ * 参数含义:f代表以下标为参数的循环体
+ */
+template <size_t N, typename F>
+inline void unrollLoop(F && f) {
+    FixedDetail::unroll(f, std::make_index_sequence<N>());
+}
+
+/**
+ * 定长非负大整数:位数Bits在编译期确定,全部数据存放在对象内部的数组中,
+ * 运算过程不申请堆内存,加减乘的循环按位数在编译期展开。
+ * 与动态长度的BigInteger可以相互转换,用于密钥长度已知的RSA加解密
+ */
+template <size_t Bits>
+class FixedBigInt {
+public:
+    typedef BigInteger::base_t base_t;
+    typedef BigInteger::dbl_t dbl_t;
+    static_assert(Bits > 0 && Bits%BigInteger::base_int == 0, "FixedBigInt的位数必须是每位二进制位数的整数倍");
+    static const size_t limbs = Bits/BigInteger::base_int;    // 按位存储需要的位数
+
+    FixedBigInt() { std::fill(limb, limb+limbs, 0); }    // 默认为0
+    explicit FixedBigInt(base_t);    // 利用单个位的数初始化
+    explicit FixedBigInt(const BigInteger &);    // 由不超过Bits位的非负大整数初始化
+    BigInteger toBigInteger() const;    // 转换为动态长度的大整数
+
+    base_t * data() { return limb; }
+    const base_t * data() const { return limb; }
+    base_t & operator [] (size_t i) { return limb[i]; }
+    const base_t & operator [] (size_t i) const { return limb[i]; }
+
+    bool isZero() const;    // 是否为0
+    bool testBit(size_t) const;    // 第i位二进制是否为1
+    size_t bitLength() const;    // 二进制位数,0的位数为0
+    int compare(const FixedBigInt &) const;    // 比较,-1、0、1分别表示小于、等于、大于
+
+    base_t add(const FixedBigInt &);    // 原位加法,返回最高位的进位
+    base_t sub(const FixedBigInt &);    // 原位减法,返回最高位的借位
+    FixedBigInt<2*Bits> multiply(const FixedBigInt &) const;// 竖式乘法,返回完整的2*Bits位乘积
+    FixedBigInt<2*Bits> square() const;    // 竖式平方,交叉项只计算一次
+
+    // 从第first位开始截取(或补0扩展)为B位的定长整数
+    template <size_t B>
+    FixedBigInt<B> part(size_t first = 0) const;
+private:
+    base_t limb[limbs];    // 按位存储,低位在前
+};
+
+/**
+ * 固定奇数模数的定长蒙哥马利上下文,R=2^Bits。
+ * 预计算在构造时借助BigInteger完成,之后的模乘、约减与幂运算都只使用定长整数
+ */
+template <size_t Bits>
+class FixedMontgomery {
+public:
+    typedef FixedBigInt<Bits> Int;
+    typedef typename Int::base_t base_t;
+    typedef typename Int::dbl_t dbl_t;
+
+    FixedMontgomery(): n_inv(0) {}    // 默认为空上下文
+    explicit FixedMontgomery(const BigInteger &);    // 利用不超过Bits位的奇数模数初始化
+
+    bool isValid() const { return n_inv != 0; }    // 是否已经初始化
+    const Int & modulus() const { return n; }    // 返回模数
+
+    Int toMont(const Int &) const;    // 转换为蒙哥马利形式,参数可以是任意Bits位的数
+    Int fromMont(const Int &) const;    // 由蒙哥马利形式转换回普通形式
+    void multiply(const Int &, const Int &, Int &) const;// 蒙哥马利乘法,结果可与乘数为同一对象
+    void square(const Int &, Int &) const;    // 蒙哥马利平方,结果可与底数为同一对象
+    Int reduce(const FixedBigInt<2*Bits> &) const;    // 求2*Bits位的数模n的余数
+    Int modPow(const Int &, const Int &) const;    // 普通形式下的幂模运算
+    BigInteger modPow(const BigInteger &, const BigInteger &) const;// 接受和返回动态长度大整数的幂模运算
+private:
+    Int n;    // 模数
+    Int r2;    // R^2 mod n
+    Int one;    // R mod n,即蒙哥马利形式的1
+    base_t n_inv;    // -n^(-1) mod 2^base_int
+};
+
+/*---------------------------FixedBigInt---------------------------*/
+
+template <size_t Bits>
+const size_t FixedBigInt<Bits>::limbs;
+
+/**
+ * 函数功能:利用单个位的数构造定长整数
+ * 参数含义:val代表给定的数
+ */
+template <size_t Bits>
+FixedBigInt<Bits>::FixedBigInt(base_t val) {
+    std::fill(limb, limb+limbs, 0);
+    limb[0] = val;
+}
+
+/**
+ * 函数功能:由动态长度的大整数构造定长整数,高位补0
+ * 参数含义:val代表给定的大整数,必须非负且不超过Bits位
+ */
+template <size_t Bits>
+FixedBigInt<Bits>::FixedBigInt(const BigInteger & val) {
+    assert(!val.is_negative && val.data.size() <= limbs);
+    std::fill(limb, limb+limbs, 0);
+    std::copy(val.data.begin(), val.data.end(), limb);
+}
+
+/**
+ * 函数功能:转换为动态长度的大整数
+ */
+template <size_t Bits>
+BigInteger FixedBigInt<Bits>::toBigInteger() const {
+    return BigInteger::fromLimbs(limb, limbs);
+}
+
+template <size_t Bits>
+bool FixedBigInt<Bits>::isZero() const {
+    base_t t = 0;
+    unrollLoop<limbs>([&](size_t i) { t |= limb[i]; });
+    return t == 0;
+}
+
+/**
+ * 函数功能:检测第id位二进制是否为1
+ * 参数含义:id代表第id位
+ */
+template <size_t Bits>
+bool FixedBigInt<Bits>::testBit(size_t id) const {
+    if (id >= Bits)
+        return false;
+    return (limb[id>>BigInteger::base_bit]>>(id & BigInteger::base_temp)) & 1;
+}
+
+template <size_t Bits>
+size_t FixedBigInt<Bits>::bitLength() const {
+    for (size_t i=limbs; i-->0; )
+        if (limb[i]) {
+            size_t ans = i*BigInteger::base_int;
+            for (base_t t=limb[i]; t; t>>=1)
+                ++ans;
+            return ans;
+        }
+    return 0;
+}
+
+/**
+ * 函数功能:比较两个定长整数
+ * 参数含义:val代表要与之比较的数
+ */
+template <size_t Bits>
+int FixedBigInt<Bits>::compare(const FixedBigInt & val) const {
+    for (size_t i=limbs; i-->0; )
+        if (limb[i] != val.limb[i])
+            return limb[i]<val.limb[i] ? -1 : 1;
+    return 0;
+}
+
+/**
+ * 函数功能:原位加法,超出Bits位的部分作为进位返回
+ * 参数含义:val代表加数
+ */
+template <size_t Bits>
+typename FixedBigInt<Bits>::base_t FixedBigInt<Bits>::add(const FixedBigInt & val) {
+    dbl_t carry = 0;
+    unrollLoop<limbs>([&](size_t i) {
+        carry += (dbl_t)limb[i]+val.limb[i];
+        limb[i] = (base_t)carry;
+        carry >>= BigInteger::base_int;
+    });
+    return (base_t)carry;
+}
+
+/**
+ * 函数功能:原位减法,被减数小于减数时结果按2^Bits回绕并返回借位1
+ * 参数含义:val代表减数
+ */
+template <size_t Bits>
+typename FixedBigInt<Bits>::base_t FixedBigInt<Bits>::sub(const FixedBigInt & val) {
+    base_t borrow = 0;
+    unrollLoop<limbs>([&](size_t i) {
+        const dbl_t diff = (dbl_t)limb[i]-val.limb[i]-borrow;
+        limb[i] = (base_t)diff;
+        borrow = (base_t)(diff>>BigInteger::base_int) & 1;
+    });
+    return borrow;
+}
+
+/**
+ * 函数功能:竖式乘法,外层逐位循环,内层按位数在编译期展开
+ * 参数含义:val代表乘数
+ */
+template <size_t Bits>
+FixedBigInt<2*Bits> FixedBigInt<Bits>::multiply(const FixedBigInt & val) const {
+    FixedBigInt<2*Bits> ans;
+    base_t * r = ans.data();
+    for (size_t i=0; i<limbs; ++i) {
+        const dbl_t a = limb[i];
+        dbl_t carry = 0;
+        unrollLoop<limbs>([&](size_t j) {
+            carry += a*val.limb[j]+r[i+j];
+            r[i+j] = (base_t)carry;
+            carry >>= BigInteger::base_int;
+        });
+        r[i+limbs] = (base_t)carry;
+    }
+    return ans;
+}
+
+/**
+ * 函数功能:竖式平方,不申请堆内存
+ */
+template <size_t Bits>
+FixedBigInt<2*Bits> FixedBigInt<Bits>::square() const {
+    FixedBigInt<2*Bits> ans;
+    BigInteger::sqrSchoolbook(limb, limbs, ans.data());
+    return ans;
+}
+
+/**
+ * 函数功能:从第first位开始截取B位,不足的高位补0
+ * 参数含义:first代表起始的位(按base_int位计)
+ */
+template <size_t Bits>
+template <size_t B>
+FixedBigInt<B> FixedBigInt<Bits>::part(size_t first) const {
+    FixedBigInt<B> ans;
+    if (first < limbs)
+        std::copy(limb+first, limb+std::min(limbs, first+FixedBigInt<B>::limbs), ans.data());
+    return ans;
+}
+
+/*-------------------------FixedMontgomery-------------------------*/
+
+/**
+ * 函数功能:根据给定的奇数模数构造定长蒙哥马利上下文,预先计算n'、R mod n与R^2 mod n
+ * 参数含义:m代表模数,必须为大于1且不超过Bits位的奇数
+ */
+template <size_t Bits>
+FixedMontgomery<Bits>::FixedMontgomery(const BigInteger & m): n(m), n_inv(0) {
+    assert(n[0] & 1);    // 模数必须为奇数
+
+    // 牛顿迭代求n[0]在模2^base_int下的逆元,与Montgomery相同
+    base_t x = n[0];
+    for (int i=0; i<5; ++i)
+        x *= 2-n[0]*x;
+    n_inv = (base_t)0-x;
+
+    BigInteger r = BigInteger::ONE;
+    one = Int(r.shiftLeft((unsigned)Bits).mod(m));
+    r2 = Int(r.shiftLeft((unsigned)(2*Bits)).mod(m));
+}
+
+/**
+ * 函数功能:转换为蒙哥马利形式,即a*R mod n
+ * 参数含义:a代表任意Bits位的数,不要求小于n
+ */
+template <size_t Bits>
+FixedBigInt<Bits> FixedMontgomery<Bits>::toMont(const Int & a) const {
+    Int ans;
+    multiply(a, r2, ans);
+    return ans;
+}
+
+/**
+ * 函数功能:将蒙哥马利形式转换回普通形式
+ * 参数含义:a代表蒙哥马利形式的数
+ */
+template <size_t Bits>
+FixedBigInt<Bits> FixedMontgomery<Bits>::fromMont(const Int & a) const {
+    Int ans;
+    multiply(a, Int(1), ans);
+    return ans;
+}
+
+/**
+ * 函数功能:CIOS方式的蒙哥马利乘法,r=a*b*R^(-1) mod n,内层循环在编译期展开。
+ *          只要a*b<R*n结果就小于n,因此a可以是任意Bits位的数
+ * 参数含义:a、b代表乘数,r代表结果
+ */
+template <size_t Bits>
+void FixedMontgomery<Bits>::multiply(const Int & a, const Int & b, Int & r) const {
+    const size_t len = Int::limbs;
+    const int w = BigInteger::base_int;
+    base_t t[len+2];
+    std::fill(t, t+len+2, 0);
+    for (size_t i=0; i<len; ++i) {
+        // t+=a*b[i]
+        dbl_t carry = 0;
+        const dbl_t bi = b[i];
+        unrollLoop<len>([&](size_t j) {
+            carry += a[j]*bi+t[j];
+            t[j] = (base_t)carry;
+            carry >>= w;
+        });
+        carry += t[len];
+        t[len] = (base_t)carry;
+        t[len+1] = (base_t)(carry>>w);
+
+        // t=(t+q*n)/2^w,q的选取使得t的最低位为0
+        const dbl_t q = (base_t)(t[0]*n_inv);
+        carry = (t[0]+q*n[0])>>w;
+        unrollLoop<len-1>([&](size_t j) {
+            carry += q*n[j+1]+t[j+1];
+            t[j] = (base_t)carry;
+            carry >>= w;
+        });
+        carry += t[len];
+        t[len-1] = (base_t)carry;
+        t[len] = t[len+1]+(base_t)(carry>>w);
+    }
+    // 结果小于2n,必要时再减一次n
+    bool ge = t[len] != 0;
+    if (!ge) {
+        ge = true;
+        for (size_t j=len; j-->0; )
+            if (t[j] != n[j]) {
+                ge = t[j] > n[j];
+                break;
+            }
+    }
+    std::copy(t, t+len, r.data());
+    if (ge)
+        r.sub(n);
+}
+
+/**
+ * 函数功能:蒙哥马利平方,r=a*a*R^(-1) mod n。先求完整的平方,再逐位约减,约减的内层循环在编译期展开
+ * 参数含义:a代表底数,须小于n,r代表结果
+ */
+template <size_t Bits>
+void FixedMontgomery<Bits>::square(const Int & a, Int & r) const {
+    const size_t len = Int::limbs;
+    const int w = BigInteger::base_int;
+    base_t t[2*len+1];
+    BigInteger::sqrSchoolbook(a.data(), len, t);
+    t[2*len] = 0;
+    for (size_t i=0; i<len; ++i) {
+        const dbl_t q = (base_t)(t[i]*n_inv);
+        dbl_t carry = 0;
+        unrollLoop<len>([&](size_t j) {
+            carry += q*n[j]+t[i+j];
+            t[i+j] = (base_t)carry;
+            carry >>= w;
+        });
+        for (size_t j=i+len; carry; ++j) {
+            carry += t[j];
+            t[j] = (base_t)carry;
+            carry >>= w;
+        }
+    }
+    // 结果t[len..2len]小于2n,必要时再减一次n
+    bool ge = t[2*len] != 0;
+    if (!ge) {
+        ge = true;
+        for (size_t j=len; j-->0; )
+            if (t[len+j] != n[j]) {
+                ge = t[len+j] > n[j];
+                break;
+            }
+    }
+    std::copy(t+len, t+2*len, r.data());
+    if (ge)
+        r.sub(n);
+}
+
+/**
+ * 函数功能:求2*Bits位的数模n的余数。x=hi*R+lo,hi*R mod n由一次蒙哥马利乘法得到,
+ *          lo mod n先转换为蒙哥马利形式再转换回来得到,最后相加
+ * 参数含义:x代表被约减的数
+ */
+template <size_t Bits>
+FixedBigInt<Bits> FixedMontgomery<Bits>::reduce(const FixedBigInt<2*Bits> & x) const {
+    Int ans = toMont(x.template part<Bits>(Int::limbs));
+    const Int lo = fromMont(toMont(x.template part<Bits>(0)));
+    if (ans.add(lo) || ans.compare(n) >= 0)
+        ans.sub(n);
+    return ans;
+}
+
+/**
+ * 函数功能:滑动窗口法求base^exponent mod n,预计算表放在栈上,不申请堆内存
+ * 参数含义:base代表底数(任意Bits位的数),exponent代表指数
+ */
+template <size_t Bits>
+FixedBigInt<Bits> FixedMontgomery<Bits>::modPow(const Int & base, const Int & exponent) const {
+    Int ans = one;
+    const size_t bits = exponent.bitLength();
+    if (bits == 0)
+        return fromMont(ans);
+    const int k = BigInteger::windowBits(bits);
+
+    // 预先计算底数的奇数次幂g[i]=base^(2i+1),蒙哥马利形式
+    const size_t cnt = (size_t)1<<(k-1);
+    Int g[(size_t)1<<5];    // windowBits不超过6
+    Int temp;
+    g[0] = toMont(base);
+    if (cnt > 1) {
+        square(g[0], temp);
+        for (size_t i=1; i<cnt; ++i)
+            multiply(g[i-1], temp, g[i]);
+    }
+
+    bool started = false;    // 是否已乘入第一个窗口
+    for (int i=(int)bits-1; i>=0; ) {
+        if (!exponent.testBit(i)) {    // 窗口外的0只需平方
+            square(ans, ans);
+            --i;
+            continue;
+        }
+        // 找到以i开头、长度不超过k且以1结尾的最长窗口
+        int l = std::max(i-k+1, 0);
+        while (!exponent.testBit(l))
+            ++l;
+        size_t val = 0;
+        for (int j=i; j>=l; --j)
+            val = (val<<1) | (exponent.testBit(j) ? 1 : 0);
+        if (started) {
+            for (int j=i; j>=l; --j)
+                square(ans, ans);
+            multiply(ans, g[val>>1], ans);
+        }
+        else {
+            ans = g[val>>1];
+            started = true;
+        }
+        i = l-1;
+    }
+    return fromMont(ans);
+}
+
+/**
+ * 函数功能:接受动态长度大整数的幂模运算,内部转换为定长整数计算
+ * 参数含义:base代表底数,exponent代表指数,均须非负且不超过Bits位
+ */
+template <size_t Bits>
+BigInteger FixedMontgomery<Bits>::modPow(const BigInteger & base, const BigInteger & exponent) const {
+    return modPow(Int(base), Int(exponent)).toBigInteger();
+}
+
+#endif // FIXEDBIGINT_H
@@ -0,0 +1,143 @@
+#ifndef INLINEVECTOR_H
+#define INLINEVECTOR_H
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include "LimbPool.h"
+
+/**
+ * 带内联缓冲区的小型动态数组:元素个数不超过N时直接存放在对象内部,
+ * 不申请堆内存;超过N时才转到堆上,堆内存取自线程局部的LimbPool。接口与std::vector的常用部分一致,
+ * 只用于可按位复制的类型(如大整数的每一位)
+ */
+template <typename T, size_t N>
+class InlineVector {
+    static_assert(std::is_trivially_copyable<T>::value, "InlineVector只支持可按位复制的类型");
+public:
+    typedef T value_type;
+    typedef T * iterator;
+    typedef const T * const_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    InlineVector(): ptr(buf), count(0), cap(N) {}
+    InlineVector(const InlineVector & val): ptr(buf), count(0), cap(N) { assign(val.begin(), val.end()); }
+    InlineVector(InlineVector && val) noexcept: ptr(buf), count(0), cap(N) { steal(val); }
+    ~InlineVector() { release(); }
+
+    InlineVector & operator = (const InlineVector & val) {
+        if (this != &val)
+            assign(val.begin(), val.end());
+        return *this;
+    }
+    InlineVector & operator = (InlineVector && val) noexcept {
+        if (this != &val) {
+            release();
+            steal(val);
+        }
+        return *this;
+    }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return cap; }
+    bool empty() const { return count == 0; }
+    bool isInline() const { return ptr == buf; }// 数据是否存放在内联缓冲区
+
+    T * data() { return ptr; }
+    const T * data() const { return ptr; }
+    T & operator [] (size_t i) { return ptr[i]; }
+    const T & operator [] (size_t i) const { return ptr[i]; }
+    T & back() { return ptr[count-1]; }
+    const T & back() const { return ptr[count-1]; }
+
+    iterator begin() { return ptr; }
+    iterator end() { return ptr+count; }
+    const_iterator begin() const { return ptr; }
+    const_iterator end() const { return ptr+count; }
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    void reserve(size_t n) {
+        if (n > cap)
+            grow(n);
+    }
+    void resize(size_t n, const T & val = T()) {
+        reserve(n);
+        if (n > count)
+            std::fill(ptr+count, ptr+n, val);
+        count = n;
+    }
+    void push_back(const T & val) {
+        if (count == cap)
+            grow(cap*2);
+        ptr[count++] = val;
+    }
+    void pop_back() { --count; }
+    void clear() { count = 0; }
+
+    void assign(size_t n, const T & val) {
+        count = 0;
+        resize(n, val);
+    }
+    template <typename Iter, typename = typename std::enable_if<!std::is_integral<Iter>::value>::type>
+    void assign(Iter first, Iter last) {
+        size_t n = std::distance(first, last);
+        count = 0;
+        reserve(n);
+        std::copy(first, last, ptr);
+        count = n;
+    }
+
+    void swap(InlineVector & val) {
+        InlineVector temp(std::move(val));
+        val = std::move(*this);
+        *this = std::move(temp);
+    }
+
+    bool operator == (const InlineVector & val) const {
+        return count==val.count && std::equal(begin(), end(), val.begin());
+    }
+    bool operator != (const InlineVector & val) const { return !(*this == val); }
+private:
+    T * ptr;    // 指向当前存放数据的位置(内联缓冲区或堆)
+    size_t count;    // 元素个数
+    size_t cap;    // 当前容量
+    T buf[N];    // 内联缓冲区
+
+    // 扩容到至少n个元素,数据转移到堆上,容量取内存池块的实际大小
+    void grow(size_t n) {
+        n = std::max(n, cap*2);
+        size_t bytes;
+        T * p = static_cast<T*>(LimbPool::Allocate(n*sizeof(T), bytes));
+        std::copy(ptr, ptr+count, p);
+        release();
+        ptr = p;
+        cap = bytes/sizeof(T);
+    }
+    // 释放堆内存,回到内联缓冲区(不保留数据)
+    void release() {
+        if (ptr != buf)
+            LimbPool::Release(ptr, cap*sizeof(T));
+        ptr = buf;
+        cap = N;
+    }
+    // 接管val的数据,val变为空
+    void steal(InlineVector & val) {
+        if (val.ptr == val.buf) {
+            std::copy(val.buf, val.buf+val.count, buf);
+        }
+        else {    // 堆上的数据直接转移指针
+            ptr = val.ptr;
+            cap = val.cap;
+            val.ptr = val.buf;
+            val.cap = N;
+        }
+        count = val.count;
+        val.count = 0;
+    }
+};
+
+#endif // INLINEVECTOR_H
@@ -0,0 +1,137 @@
+#include "LimbPool.h"
+#include <new>
+
+namespace {
+const size_t min_block = 64;    // 最小级别的字节数
+const int classes = 15;    // 级别数,最大级别为1MB
+const int depth = 16;    // 每个级别最多缓存的块数
+const size_t cache_limit = (size_t)4<<20;    // 每个线程缓存的总字节数上限
+
+/**
+ * 线程局部的空闲表,线程结束时释放缓存的块
+ */
+struct Cache {
+    void * blocks[classes][depth];
+    int count[classes];
+    size_t bytes;    // 缓存的总字节数
+    LimbPool::Counters stats;
+
+    Cache(): count(), bytes(0), stats() {}
+    ~Cache();
+    void clear();
+};
+
+// 线程结束时各线程局部对象的析构顺序不确定,Cache析构后仍可能有块被释放,此时直接交还系统
+thread_local bool cache_destroyed = false;
+thread_local Cache cache;
+
+Cache::~Cache()
+{
+    clear();
+    cache_destroyed = true;
+}
+
+void Cache::clear()
+{
+    for (int c = 0; c < classes; ++c) {
+        for (int i = 0; i < count[c]; ++i)
+            ::operator delete(blocks[c][i]);
+        count[c] = 0;
+    }
+    bytes = 0;
+}
+
+// 不小于bytes的最小级别,超过最大级别时返回classes
+int ClassOf(size_t bytes)
+{
+    int c = 0;
+    for (size_t size = min_block; size < bytes && c < classes; size <<= 1)
+        ++c;
+    return c;
+}
+
+// 本线程的空闲表,首次使用时构造,析构后返回空
+Cache * Local()
+{
+    return cache_destroyed ? nullptr : &cache;
+}
+}
+
+/**
+ * 函数功能:优先从本线程的空闲表中取出同一级别的块,没有时向系统申请
+ * 参数含义:bytes代表需要的字节数,capacity传回块的实际字节数
+ */
+void * LimbPool::Allocate(size_t bytes, size_t &capacity)
+{
+    Cache * local = Local();
+#ifndef BIGINTEGER_NO_LIMB_POOL
+    const int c = ClassOf(bytes);
+    if (c < classes) {
+        capacity = min_block<<c;
+        if (local && local->count[c] > 0) {
+            ++local->stats.hits;
+            local->bytes -= capacity;
+            return local->blocks[c][--local->count[c]];
+        }
+    }
+    else
+#endif
+        capacity = bytes;
+    if (local)
+        ++local->stats.misses;
+    return ::operator new(capacity);
+}
+
+/**
+ * 函数功能:把块放回本线程的空闲表,表满、超过总量上限或超过最大级别时交还系统
+ * 参数含义:block代表块,capacity代表申请时传回的字节数
+ */
+void LimbPool::Release(void *block, size_t capacity)
+{
+#ifndef BIGINTEGER_NO_LIMB_POOL
+    const int c = ClassOf(capacity);
+    Cache * local = Local();
+    if (c < classes && local && local->count[c] < depth && local->bytes+capacity <= cache_limit) {
+        local->blocks[c][local->count[c]++] = block;
+        local->bytes += capacity;
+        return;
+    }
+#endif
+    ::operator delete(block);
+}
+
+void LimbPool::Reset()
+{
+    if (Cache * local = Local())
+        local->clear();
+}
+
+LimbPool::Counters LimbPool::Stats()
+{
+    Cache * local = Local();
+    if (local)
+        return local->stats;
+    Counters none = {0, 0};
+    return none;
+}
+
+void LimbPool::ClearStats()
+{
+    if (Cache * local = Local())
+        local->stats = Counters();
+}
+
+namespace {
+thread_local int scope_depth = 0;    // 本线程嵌套的Scope层数
+}
+
+LimbPool::Scope::Scope()
+{
+    ++scope_depth;
+}
+
+LimbPool::Scope::~Scope()
+{
+    if (--scope_depth == 0)
+        Reset();
+}
@@ -0,0 +1,78 @@
+#ifndef LIMBPOOL_H
+#define LIMBPOOL_H
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * 按大小分级的线程局部内存池:块大小为64字节乘以2的幂,释放的块留在本线程的空闲表中,
+ * 下次申请同一级别时直接取出,不经过operator new。每个线程缓存的总量有上限,
+ * 超过上限或超过最大级别的块直接交还系统。大整数的堆存储与乘除法的临时数组都从这里申请。
+ * 定义BIGINTEGER_NO_LIMB_POOL时所有申请直接使用operator new,计数器只统计未命中
+ */
+class LimbPool
+{
+public:
+    // 计数器:hits为从空闲表取出的次数,misses为向系统申请的次数
+    struct Counters {
+        size_t hits;
+        size_t misses;
+    };
+
+    // 申请至少bytes字节,capacity传回实际大小,释放时须原样传回
+    static void * Allocate(size_t bytes, size_t &capacity);
+    static void Release(void *block, size_t capacity);
+    // 把本线程缓存的块全部交还系统,在一次完整的运算结束时调用
+    static void Reset();
+    // 本线程的计数器
+    static Counters Stats();
+    static void ClearStats();
+
+    /**
+     * 运算边界:最外层的Scope析构时调用Reset,嵌套的Scope不起作用
+     */
+    class Scope {
+    public:
+        Scope();
+        ~Scope();
+        Scope(const Scope &) = delete;
+        Scope & operator = (const Scope &) = delete;
+    };
+};
+
+/**
+ * 从LimbPool申请的定长临时数组,元素初始化为0,用于替代运算内部的std::vector
+ */
+template <typename T>
+class ScratchBuffer
+{
+    static_assert(std::is_trivially_copyable<T>::value, "ScratchBuffer只支持可按位复制的类型");
+public:
+    explicit ScratchBuffer(size_t n): count(n), capacity(0) {
+        ptr = static_cast<T*>(LimbPool::Allocate(std::max<size_t>(n, 1)*sizeof(T), capacity));
+        std::fill(ptr, ptr+n, T());
+    }
+    template <typename Iter>
+    ScratchBuffer(Iter first, Iter last): count(0), capacity(0) {
+        count = std::distance(first, last);
+        ptr = static_cast<T*>(LimbPool::Allocate(std::max<size_t>(count, 1)*sizeof(T), capacity));
+        std::copy(first, last, ptr);
+    }
+    ~ScratchBuffer() { LimbPool::Release(ptr, capacity); }
+    ScratchBuffer(const ScratchBuffer &) = delete;
+    ScratchBuffer & operator = (const ScratchBuffer &) = delete;
+
+    size_t size() const { return count; }
+    T * data() { return ptr; }
+    const T * data() const { return ptr; }
+    T & operator [] (size_t i) { return ptr[i]; }
+    const T & operator [] (size_t i) const { return ptr[i]; }
+    T * begin() { return ptr; }
+    T * end() { return ptr+count; }
+private:
+    T * ptr;
+    size_t count;    // 元素个数
+    size_t capacity;    // 实际申请的字节数
+};
+
+#endif // LIMBPOOL_H
@@ -0,0 +1,301 @@
+#include <algorithm>
+#include <cassert>
+#include "Montgomery.h"
+
+/**
+ * 函数功能:根据给定的奇数模数构造蒙哥马利上下文,预先计算n'与R^2 mod n
+ * 参数含义:m代表模数,必须为大于1的奇数
+ */
+Montgomery::Montgomery(const BigInteger & m): n(m.abs()), n_inv(0), len(0) {
+    assert(n.data[0] & 1);    // 模数必须为奇数
+    n_limbs.assign(n.data.begin(), n.data.end());
+    len = n_limbs.size();
+
+    // 牛顿迭代求n[0]在模2^base_int下的逆元,每次迭代正确位数翻倍
+    base_t x = n_limbs[0];    // 奇数的平方模8余1,初值已有3位正确
+    for (int i=0; i<5; ++i)
+        x *= 2-n_limbs[0]*x;
+    n_inv = (base_t)0-x;
+
+    BigInteger r = BigInteger::ONE;
+    r2 = r.shiftLeft((unsigned)(2*len*BigInteger::base_int)).mod(n);
+}
+
+/**
+ * 函数功能:利用事先保存的预计算值恢复上下文,只做廉价的一致性检查
+ * 参数含义:m代表奇数模数,r代表R^2 mod n,inv代表-n^(-1) mod 2^base_int
+ */
+Montgomery::Montgomery(const BigInteger & m, const BigInteger & r, base_t inv)
+    : n(m.abs()), r2(r), n_inv(inv), len(0) {
+    assert(n.data[0] & 1);    // 模数必须为奇数
+    assert((base_t)(n.data[0]*n_inv) == (base_t)0-1);    // n*n'≡-1
+    assert(!r2.is_negative && r2.compareTo(n) < 0);
+    n_limbs.assign(n.data.begin(), n.data.end());
+    len = n_limbs.size();
+}
+
+/**
+ * 函数功能:将给定的大整数转换为蒙哥马利形式
+ * 参数含义:a代表给定的大整数
+ */
+BigInteger Montgomery::toMont(const BigInteger & a) const {
+    BigInteger t(a);
+    if (t.is_negative || t.compareTo(n) >= 0)
+        t = t.mod(n);
+    return multiply(t, r2);
+}
+
+/**
+ * 函数功能:将蒙哥马利形式的大整数转换回普通形式
+ * 参数含义:a代表蒙哥马利形式的大整数
+ */
+BigInteger Montgomery::fromMont(const BigInteger & a) const {
+    return multiply(a, BigInteger::ONE);
+}
+
+/**
+ * 函数功能:蒙哥马利乘法,返回a*b*R^(-1) mod n
+ * 参数含义:a、b代表乘数,均须小于n
+ */
+BigInteger Montgomery::multiply(const BigInteger & a, const BigInteger & b) const {
+    ScratchBuffer<base_t> x(len), y(len), r(len), t(len+2);
+    load(a, x.data());
+    load(b, y.data());
+    montMul(x.data(), y.data(), r.data(), t.data());
+    return store(r.data());
+}
+
+/**
+ * 函数功能:蒙哥马利平方,返回a*a*R^(-1) mod n
+ * 参数含义:a代表底数,须小于n
+ */
+BigInteger Montgomery::square(const BigInteger & a) const {
+    ScratchBuffer<base_t> x(len), r(len), t(2*len+1);
+    load(a, x.data());
+    montSqr(x.data(), r.data(), t.data());
+    return store(r.data());
+}
+
+/**
+ * 函数功能:蒙哥马利形式下的幂运算,底数和结果都为蒙哥马利形式
+ * 参数含义:base代表底数(蒙哥马利形式),exponent代表指数
+ */
+BigInteger Montgomery::powMont(const BigInteger & base, const BigInteger & exponent) const {
+    ScratchBuffer<base_t> ans(len), temp(len), t(len+2), s(2*len+1);
+    load(toMont(BigInteger::ONE), ans.data());    // R mod n即为蒙哥马利形式的1
+    if (exponent.equals(BigInteger::ZERO))
+        return store(ans.data());
+
+    BigInteger::bit e(exponent);
+    const int k = BigInteger::windowBits(e.size());
+
+    // 预先计算底数的奇数次幂g[i]=base^(2i+1),连续存放
+    const size_t cnt = (size_t)1<<(k-1);
+    ScratchBuffer<base_t> g(cnt*len);
+    load(base, g.data());
+    if (cnt > 1) {
+        montSqr(g.data(), temp.data(), s.data());
+        for (size_t i=1; i<cnt; ++i)
+            montMul(g.data()+(i-1)*len, temp.data(), g.data()+i*len, t.data());
+    }
+
+    bool started = false;    // 是否已乘入第一个窗口
+    for (int i=e.size()-1; i>=0; ) {
+        if (!e.at(i)) {    // 窗口外的0只需平方
+            montSqr(ans.data(), ans.data(), s.data());
+            --i;
+            continue;
+        }
+        // 找到以i开头、长度不超过k且以1结尾的最长窗口
+        int l = std::max(i-k+1, 0);
+        while (!e.at(l))
+            ++l;
+        size_t val = 0;
+        for (int j=i; j>=l; --j)
+            val = (val<<1) | (e.at(j) ? 1 : 0);
+        const base_t * gv = g.data()+(val>>1)*len;
+        if (started) {
+            for (int j=i; j>=l; --j)
+                montSqr(ans.data(), ans.data(), s.data());
+            montMul(ans.data(), gv, ans.data(), t.data());
+        }
+        else {
+            std::copy(gv, gv+len, ans.begin());
+            started = true;
+        }
+        i = l-1;
+    }
+    return store(ans.data());
+}
+
+/**
+ * 函数功能:普通形式下的幂模运算,返回base^exponent mod n
+ * 参数含义:base代表底数,exponent代表指数
+ */
+BigInteger Montgomery::modPow(const BigInteger & base, const BigInteger & exponent) const {
+    return fromMont(powMont(toMont(base), exponent));
+}
+
+/**
+ * 函数功能:将小于n的非负大整数展开为len位,高位补0
+ * 参数含义:a代表给定的大整数,p代表输出数组
+ */
+void Montgomery::load(const BigInteger & a, base_t * p) const {
+    assert(!a.is_negative && a.data.size() <= len);
+    std::fill(p, p+len, 0);
+    std::copy(a.data.begin(), a.data.end(), p);
+}
+
+/**
+ * 函数功能:将len位数据转换为大整数
+ * 参数含义:p代表数据首地址
+ */
+BigInteger Montgomery::store(const base_t * p) const {
+    return BigInteger::fromLimbs(p, len);
+}
+
+/**
+ * 函数功能:CIOS方式的蒙哥马利乘法,r=a*b*R^(-1) mod n,乘法与约减逐位交替进行
+ * 参数含义:a、b代表乘数(len位),r代表结果(len位,可与a、b为同一数组),t为len+2位的临时空间
+ */
+void Montgomery::montMul(const base_t * a, const base_t * b, base_t * r, base_t * t) const {
+    const int w = BigInteger::base_int;
+    const base_t * m = n_limbs.data();
+    std::fill(t, t+len+2, 0);
+    for (size_t i=0; i<len; ++i) {
+        // t+=a*b[i]
+        dbl_t carry = 0;
+        const dbl_t bi = b[i];
+        for (size_t j=0; j<len; ++j) {
+            carry += a[j]*bi+t[j];
+            t[j] = (base_t)carry;
+            carry >>= w;
+        }
+        carry += t[len];
+        t[len] = (base_t)carry;
+        t[len+1] = (base_t)(carry>>w);
+
+        // t=(t+q*n)/2^w,q的选取使得t的最低位为0
+        const dbl_t q = (base_t)(t[0]*n_inv);
+        carry = (t[0]+q*m[0])>>w;
+        for (size_t j=1; j<len; ++j) {
+            carry += q*m[j]+t[j];
+            t[j-1] = (base_t)carry;
+            carry >>= w;
+        }
+        carry += t[len];
+        t[len-1] = (base_t)carry;
+        t[len] = t[len+1]+(base_t)(carry>>w);
+    }
+    // 结果小于2n,必要时再减一次n
+    bool ge = t[len] != 0;
+    if (!ge) {
+        ge = true;
+        for (size_t j=len; j-->0; )
+            if (t[j] != m[j]) {
+                ge = t[j] > m[j];
+                break;
+            }
+    }
+    if (ge)
+        BigInteger::subLimbs(r, t, len, m, len);
+    else
+        std::copy(t, t+len, r);
+}
+
+/**
+ * 函数功能:蒙哥马利平方,r=a*a*R^(-1) mod n。平方的交叉项只算一次,再逐位约减,
+ *          乘法次数约为1.5*len^2,少于montMul的2*len^2
+ * 参数含义:a代表底数(len位),r代表结果(len位,可与a为同一数组),t为2*len+1位的临时空间
+ */
+void Montgomery::montSqr(const base_t * a, base_t * r, base_t * t) const {
+    const int w = BigInteger::base_int;
+    const base_t * m = n_limbs.data();
+    if (len < BigInteger::karatsuba_sqr_threshold)
+        BigInteger::sqrSchoolbook(a, len, t);
+    else
+        BigInteger::sqrKaratsuba(a, len, t);
+    t[2*len] = 0;
+    // 每次加上q*n*2^(w*i)使第i位变为0,最终t/R即为结果
+    for (size_t i=0; i<len; ++i) {
+        const dbl_t q = (base_t)(t[i]*n_inv);
+        dbl_t carry = 0;
+        for (size_t j=0; j<len; ++j) {
+            carry += q*m[j]+t[i+j];
+            t[i+j] = (base_t)carry;
+            carry >>= w;
+        }
+        for (size_t j=i+len; carry; ++j) {
+            carry += t[j];
+            t[j] = (base_t)carry;
+            carry >>= w;
+        }
+    }
+    // 结果t[len..2len]小于2n,必要时再减一次n
+    const base_t * u = t+len;
+    bool ge = u[len] != 0;
+    if (!ge) {
+        ge = true;
+        for (size_t j=len; j-->0; )
+            if (u[j] != m[j]) {
+                ge = u[j] > m[j];
+                break;
+            }
+    }
+    if (ge)
+        BigInteger::subLimbs(r, u, len, m, len);
+    else
+        std::copy(u, u+len, r);
+}
+
+/**
+ * 函数功能:为固定底数构造梳状幂运算的预计算表
+ * 参数含义:ctx代表模数的蒙哥马利上下文,base代表底数,max_bits代表指数的最大二进制长度,width代表梳齿数
+ */
+FixedBaseComb::FixedBaseComb(const Montgomery & ctx, const BigInteger & base, size_t max_bits, unsigned width)
+    : mont(ctx), width(width), cols((max_bits+width-1)/width) {
+    assert(width > 0 && width < 16);
+    // 将指数按二进制排成width行cols列,第j行对应底数的2^(j*cols)次幂
+    std::vector<BigInteger> rows(width);
+    rows[0] = mont.toMont(base);
+    for (unsigned j=1; j<width; ++j) {
+        rows[j] = rows[j-1];
+        for (size_t c=0; c<cols; ++c)
+            rows[j] = mont.square(rows[j]);
+    }
+    // table[i]为i的二进制中为1的各行之积
+    table.resize((size_t)1<<width);
+    table[0] = mont.toMont(BigInteger::ONE);
+    for (size_t i=1; i<table.size(); ++i) {
+        unsigned j = 0;
+        while (!((i>>j) & 1))
+            ++j;
+        table[i] = (i == ((size_t)1<<j)) ? rows[j] : mont.multiply(table[i&(i-1)], rows[j]);
+    }
+}
+
+/**
+ * 函数功能:求base^exponent mod n,每一列只需一次平方和至多一次乘法
+ * 参数含义:exponent代表指数,超出预计算长度时退回滑动窗口法
+ */
+BigInteger FixedBaseComb::modPow(const BigInteger & exponent) const {
+    if (exponent.equals(BigInteger::ZERO))
+        return mont.fromMont(table[0]);
+    BigInteger::bit e(exponent);
+    if (e.size() > cols*width)
+        return mont.fromMont(mont.powMont(table[1], exponent));
+
+    BigInteger ans = table[0];
+    for (size_t c=cols; c-->0; ) {
+        ans = mont.square(ans);
+        size_t idx = 0;
+        for (unsigned j=0; j<width; ++j) {
+            size_t pos = j*cols+c;
+            if (pos < e.size() && e.at(pos))
+                idx |= (size_t)1<<j;
+        }
+        if (idx)
+            ans = mont.multiply(ans, table[idx]);
+    }
+    return mont.fromMont(ans);
+}
@@ -0,0 +1,59 @@
+#ifndef MONTGOMERY_H
+#define MONTGOMERY_H
+#include <vector>
+#include "BigInteger.h"
+
+/**
+ * 蒙哥马利模乘上下文:对固定的奇数模数n预先计算R^2 mod n与n'=-n^(-1) mod 2^base_int,
+ * 之后的模乘只需乘法和移位,不再需要长除法。R=2^(base_int*len),len为n的位数
+ */
+class Montgomery {
+public:
+    typedef BigInteger::base_t base_t;
+    typedef BigInteger::dbl_t dbl_t;
+
+    Montgomery(): n_inv(0), len(0) {}// 默认为空上下文
+    explicit Montgomery(const BigInteger &);// 利用给定的奇数模数初始化
+    Montgomery(const BigInteger &, const BigInteger &, base_t);// 利用保存的模数、R^2 mod n和n'恢复,不再重新计算
+
+    bool isValid() const { return len != 0; }// 是否已经初始化
+    const BigInteger & modulus() const { return n; }// 返回模数
+    const BigInteger & rSquare() const { return r2; }// 返回R^2 mod n
+    base_t negInverse() const { return n_inv; }// 返回n'
+
+    BigInteger toMont(const BigInteger &) const;    // 转换为蒙哥马利形式,即a*R mod n
+    BigInteger fromMont(const BigInteger &) const;    // 由蒙哥马利形式转换回普通形式
+    BigInteger multiply(const BigInteger &, const BigInteger &) const;// 蒙哥马利乘法,a*b*R^(-1) mod n
+    BigInteger square(const BigInteger &) const;    // 蒙哥马利平方,a*a*R^(-1) mod n
+    BigInteger powMont(const BigInteger &, const BigInteger &) const;// 蒙哥马利形式下的幂运算
+    BigInteger modPow(const BigInteger &, const BigInteger &) const;// 普通形式下的幂模运算
+private:
+    BigInteger n;    // 模数
+    BigInteger r2;    // R^2 mod n
+    base_t n_inv;    // -n^(-1) mod 2^base_int
+    size_t len;    // 模数的位数
+    std::vector<base_t> n_limbs;    // 模数按位存储,便于直接运算
+
+    void load(const BigInteger &, base_t *) const;    // 将小于n的大整数展开为len位
+    BigInteger store(const base_t *) const;    // 将len位数据转换为大整数
+    void montMul(const base_t *, const base_t *, base_t *, base_t *) const;// 按位的蒙哥马利乘法
+    void montSqr(const base_t *, base_t *, base_t *) const;// 按位的蒙哥马利平方,先平方再约减
+};
+
+/**
+ * 固定底数的梳状幂运算(Lim-Lee comb):同一底数a对同一模数反复求a^d mod n时,
+ * 预先计算2^width个组合幂,之后每次幂运算的平方次数减少为原来的1/width
+ */
+class FixedBaseComb {
+public:
+    FixedBaseComb(const Montgomery &, const BigInteger &, size_t, unsigned width = 4);
+
+    BigInteger modPow(const BigInteger &) const;// 求base^exponent mod n
+private:
+    Montgomery mont;    // 模数的蒙哥马利上下文
+    unsigned width;    // 梳齿数,即指数被分成的行数
+    size_t cols;    // 每行的二进制位数
+    std::vector<BigInteger> table;    // 预计算表,蒙哥马利形式
+};
+
+#endif // MONTGOMERY_H
@@ -0,0 +1,152 @@
+#include "Poly1305.h"
+#include <cstring>
+
+namespace {
+inline uint32_t LoadLE(const unsigned char *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1]<<8) | ((uint32_t)p[2]<<16) | ((uint32_t)p[3]<<24);
+}
+
+inline void StoreLE(unsigned char *p, uint32_t w)
+{
+    p[0] = (unsigned char)w;
+    p[1] = (unsigned char)(w>>8);
+    p[2] = (unsigned char)(w>>16);
+    p[3] = (unsigned char)(w>>24);
+}
+}
+
+/**
+ * 函数功能:由32字节的一次性密钥初始化,r按规范清除部分位后拆成5个26位的数
+ * 参数含义:key代表密钥
+ */
+Poly1305::Poly1305(const unsigned char key[32]): leftover(0)
+{
+    r[0] = (LoadLE(key+0)) & 0x3ffffff;
+    r[1] = (LoadLE(key+3)>>2) & 0x3ffff03;
+    r[2] = (LoadLE(key+6)>>4) & 0x3ffc0ff;
+    r[3] = (LoadLE(key+9)>>6) & 0x3f03fff;
+    r[4] = (LoadLE(key+12)>>8) & 0x00fffff;
+    for (int i = 0; i < 5; ++i)
+        h[i] = 0;
+    for (int i = 0; i < 4; ++i)
+        pad[i] = LoadLE(key+16+4*i);
+}
+
+/**
+ * 函数功能:h=(h+m)*r mod 2^130-5,m为16字节分组加上第128位的1(最后不足一组时为0)
+ * 参数含义:data代表分组,len代表字节数(16的倍数),hibit代表第128位
+ */
+void Poly1305::Blocks(const unsigned char *data, size_t len, uint32_t hibit)
+{
+    const uint32_t r0 = r[0], r1 = r[1], r2 = r[2], r3 = r[3], r4 = r[4];
+    const uint32_t s1 = r1*5, s2 = r2*5, s3 = r3*5, s4 = r4*5;    // 2^130≡5,高位折回低位
+    uint32_t h0 = h[0], h1 = h[1], h2 = h[2], h3 = h[3], h4 = h[4];
+    for (; len >= 16; data += 16, len -= 16) {
+        h0 += (LoadLE(data+0)) & 0x3ffffff;
+        h1 += (LoadLE(data+3)>>2) & 0x3ffffff;
+        h2 += (LoadLE(data+6)>>4) & 0x3ffffff;
+        h3 += (LoadLE(data+9)>>6) & 0x3ffffff;
+        h4 += (LoadLE(data+12)>>8) | hibit;
+
+        const uint64_t d0 = (uint64_t)h0*r0+(uint64_t)h1*s4+(uint64_t)h2*s3+(uint64_t)h3*s2+(uint64_t)h4*s1;
+        uint64_t d1 = (uint64_t)h0*r1+(uint64_t)h1*r0+(uint64_t)h2*s4+(uint64_t)h3*s3+(uint64_t)h4*s2;
+        uint64_t d2 = (uint64_t)h0*r2+(uint64_t)h1*r1+(uint64_t)h2*r0+(uint64_t)h3*s4+(uint64_t)h4*s3;
+        uint64_t d3 = (uint64_t)h0*r3+(uint64_t)h1*r2+(uint64_t)h2*r1+(uint64_t)h3*r0+(uint64_t)h4*s4;
+        uint64_t d4 = (uint64_t)h0*r4+(uint64_t)h1*r3+(uint64_t)h2*r2+(uint64_t)h3*r1+(uint64_t)h4*r0;
+
+        // 部分进位,结果仍可能略大于2^130-5,留到Final再完全约减
+        uint32_t c = (uint32_t)(d0>>26); h0 = (uint32_t)d0 & 0x3ffffff;
+        d1 += c; c = (uint32_t)(d1>>26); h1 = (uint32_t)d1 & 0x3ffffff;
+        d2 += c; c = (uint32_t)(d2>>26); h2 = (uint32_t)d2 & 0x3ffffff;
+        d3 += c; c = (uint32_t)(d3>>26); h3 = (uint32_t)d3 & 0x3ffffff;
+        d4 += c; c = (uint32_t)(d4>>26); h4 = (uint32_t)d4 & 0x3ffffff;
+        h0 += c*5; c = h0>>26; h0 &= 0x3ffffff;
+        h1 += c;
+    }
+    h[0] = h0; h[1] = h1; h[2] = h2; h[3] = h3; h[4] = h4;
+}
+
+/**
+ * 函数功能:追加消息,凑满16字节的部分直接处理,剩余字节留在缓冲区
+ * 参数含义:data代表消息,len代表字节数
+ */
+void Poly1305::Update(const unsigned char *data, size_t len)
+{
+    if (leftover) {
+        size_t want = 16-leftover;
+        if (want > len)
+            want = len;
+        std::memcpy(buffer+leftover, data, want);
+        leftover += want;
+        data += want;
+        len -= want;
+        if (leftover < 16)
+            return;
+        Blocks(buffer, 16, 1u<<24);
+        leftover = 0;
+    }
+    const size_t whole = len & ~(size_t)15;
+    if (whole) {
+        Blocks(data, whole, 1u<<24);
+        data += whole;
+        len -= whole;
+    }
+    if (len) {
+        std::memcpy(buffer, data, len);
+        leftover = len;
+    }
+}
+
+/**
+ * 函数功能:处理最后不足一组的字节,把h完全约减到[0,2^130-5),再加上s得到认证码
+ * 参数含义:tag传回16字节的认证码
+ */
+void Poly1305::Final(unsigned char tag[16])
+{
+    if (leftover) {
+        buffer[leftover] = 1;    // 最后一组在消息末尾补1,不再加第128位
+        for (size_t i = leftover+1; i < 16; ++i)
+            buffer[i] = 0;
+        Blocks(buffer, 16, 0);
+    }
+
+    uint32_t h0 = h[0], h1 = h[1], h2 = h[2], h3 = h[3], h4 = h[4];
+    uint32_t c = h1>>26; h1 &= 0x3ffffff;
+    h2 += c; c = h2>>26; h2 &= 0x3ffffff;
+    h3 += c; c = h3>>26; h3 &= 0x3ffffff;
+    h4 += c; c = h4>>26; h4 &= 0x3ffffff;
+    h0 += c*5; c = h0>>26; h0 &= 0x3ffffff;
+    h1 += c;
+
+    // g=h+5-2^130,不小于0时取g,用掩码选择
+    uint32_t g0 = h0+5; c = g0>>26; g0 &= 0x3ffffff;
+    uint32_t g1 = h1+c; c = g1>>26; g1 &= 0x3ffffff;
+    uint32_t g2 = h2+c; c = g2>>26; g2 &= 0x3ffffff;
+    uint32_t g3 = h3+c; c = g3>>26; g3 &= 0x3ffffff;
+    uint32_t g4 = h4+c-(1u<<26);
+    uint32_t mask = (g4>>31)-1;    // g4没有借位时全1
+    h0 = (h0 & ~mask) | (g0 & mask);
+    h1 = (h1 & ~mask) | (g1 & mask);
+    h2 = (h2 & ~mask) | (g2 & mask);
+    h3 = (h3 & ~mask) | (g3 & mask);
+    h4 = (h4 & ~mask) | (g4 & mask);
+
+    // 拼成128位后加上s
+    const uint32_t w0 = h0 | (h1<<26);
+    const uint32_t w1 = (h1>>6) | (h2<<20);
+    const uint32_t w2 = (h2>>12) | (h3<<14);
+    const uint32_t w3 = (h3>>18) | (h4<<8);
+    uint64_t f = (uint64_t)w0+pad[0];            StoreLE(tag+0, (uint32_t)f);
+    f = (uint64_t)w1+pad[1]+(f>>32);            StoreLE(tag+4, (uint32_t)f);
+    f = (uint64_t)w2+pad[2]+(f>>32);            StoreLE(tag+8, (uint32_t)f);
+    f = (uint64_t)w3+pad[3]+(f>>32);            StoreLE(tag+12, (uint32_t)f);
+}
+
+bool Poly1305::Equal(const unsigned char a[16], const unsigned char b[16])
+{
+    unsigned diff = 0;
+    for (int i = 0; i < 16; ++i)
+        diff |= a[i]^b[i];
+    return diff == 0;
+}
@@ -0,0 +1,29 @@
+#ifndef POLY1305_H
+#define POLY1305_H
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Poly1305一次性消息认证码(RFC 8439):在模2^130-5下按16字节分组求多项式的值,
+ * 每个32字节的密钥只能认证一条消息。内部用5个26位的数表示130位整数,只需要64位乘法
+ */
+class Poly1305
+{
+public:
+    explicit Poly1305(const unsigned char key[32]);    // key的前16字节为r,后16字节为s
+
+    void Update(const unsigned char *data, size_t len);    // 追加消息
+    void Final(unsigned char tag[16]);    // 输出16字节的认证码
+    // 比较两个认证码,耗时与内容无关
+    static bool Equal(const unsigned char a[16], const unsigned char b[16]);
+private:
+    uint32_t r[5];    // 截断后的r
+    uint32_t h[5];    // 累加值
+    uint32_t pad[4];    // s
+    unsigned char buffer[16];    // 不足一组的剩余字节
+    size_t leftover;    // buffer中的字节数
+
+    void Blocks(const unsigned char *data, size_t len, uint32_t hibit);// 处理若干个完整分组
+};
+
+#endif // POLY1305_H
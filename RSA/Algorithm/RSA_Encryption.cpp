@@ -1,211 +1,289 @@
 #include "RSA_Encryption.h"
-#include <ctime>
-#include <sstream>
-#include <assert.h>
 #include <QDebug>
-#include <bitset>
+#include <algorithm>
 /**
  * 函数功能:初始化RSA对象的相关信息
  * 参数含义:len表示大素数的二进制位数
  */
 RSA_Encryption::RSA_Encryption(QObject *parent)
-    :QObject(parent),hasKey(false) {}
+    :QObject(parent),mode(BLOCK) {}
 
 void RSA_Encryption::Initial(const unsigned int &length){
     emit SendProgress(0.0);
-    hasKey = true;
-    srand((unsigned)time(nullptr));
-    // 产生大素数p和q
-    emit SendProgress(0.1);
-    p = CreatePrime(length, 15);// 出错概率为(1/4)^15
-    emit SendProgress(0.4);
-    q = CreatePrime(length, 15);
-    emit SendProgress(0.6);
-    // 计算出n
-    n = p*q;
-    // 计算出n的欧拉函数
-    eul = (p-1)*(q-1);
-    emit SendProgress(0.7);
-    // 设置加解密指数e和d
-    CreateExponent(eul);
+    // 密钥生成不依赖Qt,进度通过回调转发为信号
+    key.Generate(length, [this](double progress) { emit SendProgress(progress); });
     emit SendProgress(1.0);
 }
 
-QString RSA_Encryption::EncodeMessage(const QString &message){
-    QString result;
-    std::string record = message.toStdString();
-    std::string ret;
-    emit SendProgress(0.0);
-    // 对明文进行加密
-    for(auto x = 0;x < record.size();++x){
-        std::bitset<8> trans(record[x]);
-        BigInteger tar(trans.to_ulong());
-        BigInteger Bec = this->EncryptByPublicKey(tar);
-        ret += Bec.toString();
-        ret += " ";
-        emit SendProgress((double)x/(double)(record.size()-1.0));
-    }
-    result = QString::fromStdString(ret);
-    return result;
+void RSA_Encryption::setMode(int index)
+{
+    this->mode = static_cast<MODE>(index);
 }
 
-QString RSA_Encryption::DecodeMessage(const QString &message){
-    QString result;
-    QStringList textList = message.split(" ");
-    std::string ret;
-    emit SendProgress(0.0);
-    // 对密文进行解密
-    for(auto x = 0;x < textList.size()-1;++x){
-        std::string word = textList.at(x).toStdString();
-        BigInteger trans(word);
-        BigInteger bec = this->DecryptByPrivateKey(trans);
-        word = bec.toString();
-        char tmp[10];
-        strcpy(tmp,word.c_str());
-        int num;
-        sscanf(tmp,"%X",&num);
-        std::bitset<8> final(num);
-        strcpy(tmp,(char*)&final);
-        ret += tmp;
-        emit SendProgress((double)x/(double)(textList.size()-2.0));
-    }
-    result = QString::fromStdString(ret);
-    return result;
+bool RSA_Encryption::SaveKey(const QString &path) const
+{
+    return key.Save(path.toLocal8Bit().toStdString());
 }
 
-QString RSA_Encryption::GetPublicKey() const
+bool RSA_Encryption::LoadKey(const QString &path)
 {
-    return QString::fromStdString(public_key.toString());
+    return key.Load(path.toLocal8Bit().toStdString());
 }
 
-QString RSA_Encryption::GetPrivateKey() const
+/**
+ * 函数功能:把会话密钥作为一个明文分组用公钥加密,供混合加密使用
+ * 参数含义:secret表示会话密钥,长度不能超过KeyBlockBytes
+ */
+QByteArray RSA_Encryption::WrapKey(const QByteArray &secret){
+    if(!key.IsValid() || secret.size() > KeyBlockBytes())return QByteArray();
+    const unsigned char *in = reinterpret_cast<const unsigned char*>(secret.constData());
+    std::vector<BigInteger> blocks(1, BigInteger::fromBytes(in, secret.size()));
+    std::vector<BigInteger> cipher = EncryptBlocks(blocks);
+    return PackBinary(secret.size(), cipher.data(), 1).mid(4);    // 不需要长度前缀
+}
+
+/**
+ * 函数功能:用私钥还原WrapKey包装的会话密钥,格式错误时返回空
+ * 参数含义:wrapped表示包装后的密钥,length表示会话密钥的字节数
+ */
+QByteArray RSA_Encryption::UnwrapKey(const QByteArray &wrapped, int length){
+    if(!key.IsValid() || wrapped.size() != CipherBlockBytes() || length < 0 || length > KeyBlockBytes())return QByteArray();
+    const unsigned char *in = reinterpret_cast<const unsigned char*>(wrapped.constData());
+    std::vector<BigInteger> blocks(1, BigInteger::fromBytes(in, wrapped.size()));
+    if(blocks[0] >= key.Modulus())return QByteArray();
+    std::vector<BigInteger> plain = DecryptBlocks(blocks);
+    QByteArray result(length, '\0');
+    plain[0].toBytes(reinterpret_cast<unsigned char*>(result.data()), length);
+    return result;
+}
+
+int RSA_Encryption::KeyBlockBytes() const
 {
-    return QString::fromStdString(private_key.toString());
+    return key.IsValid() ? int(key.PlainBlockBytes()) : 0;
 }
 
-bool RSA_Encryption::GenearteKey() const
+int RSA_Encryption::CipherBlockBytes() const
 {
-    return hasKey;
+    return key.IsValid() ? int(key.CipherBlockBytes()) : 0;
+}
+
+QString RSA_Encryption::EncodeMessage(const QString &message){
+    return EncodeMessages(QStringList(message)).front();
+}
+
+QString RSA_Encryption::DecodeMessage(const QString &message){
+    return DecodeMessages(QStringList(message)).front();
 }
 
 /**
- * 函数功能:使用公钥进行加密
- * 参数含义:m表示要加密的明文
+ * 函数功能:分组模式加密为二进制密文,尚未生成或载入密钥时返回空
+ * 参数含义:message表示明文
  */
-BigInteger RSA_Encryption::EncryptByPublicKey(const BigInteger &target)
-{
-    return target.modPow(public_key, n);
+QByteArray RSA_Encryption::EncodeMessageBinary(const QString &message){
+    if(!key.IsValid())return QByteArray();
+    std::string record = message.toStdString();
+    std::vector<BigInteger> blocks;
+    SplitPlain(record, BLOCK, blocks);
+    std::vector<BigInteger> cipher = EncryptBlocks(blocks);
+    return PackBinary(record.size(), cipher.data(), cipher.size());
 }
 
 /**
- * 函数功能:使用私钥进行解密
- * 参数含义:c表示要解密的密文
+ * 函数功能:解密二进制密文,没有密钥或格式错误时返回空
+ * 参数含义:cipher表示EncodeMessageBinary输出的密文
  */
-BigInteger RSA_Encryption::DecryptByPrivateKey(const BigInteger &target)
-{
-    return target.modPow(private_key, n);
+QString RSA_Encryption::DecodeMessageBinary(const QByteArray &cipher){
+    if(!key.IsValid())return QString();
+    std::vector<BigInteger> blocks;
+    size_t length;
+    if(!UnpackBinary(cipher, blocks, length))return QString();
+    std::vector<BigInteger> plain = DecryptBlocks(blocks);
+    return JoinPlain(length, false, plain.data(), plain.size());
+}
+
+namespace {
+// 一条消息在合并后的分组序列中的位置
+struct Piece {
+    size_t offset, count;    // 第一个分组的下标和分组数
+    size_t length;    // 明文的字节数
+    bool byte;    // 是否为逐字节模式的密文
+    bool valid;    // 密文格式是否正确
+};
 }
 
 /**
- * 函数功能:生成一个长度为length的奇数
- * 参数含义:length代表奇数的二进制长度
+ * 函数功能:批量加密多条消息,所有消息的分组合并为一批并行加密,再按消息拆分输出,
+ *          尚未生成或载入密钥时每条都返回空串
+ * 参数含义:messages表示明文列表,返回的密文与之一一对应
  */
-BigInteger RSA_Encryption::CreateOddNum(unsigned int length)
-{
-    static const char hex_table[] = {'0', '1', '2', '3', '4', '5', '6', '7',
-                                     '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
-    length >>= 2;    // 十六进制数据,每位占4位二进制
-    if (length) {
-        std::ostringstream oss;
-        for (size_t i = 0; i < length-1; ++i)
-            oss << hex_table[rand()%16];
-        oss << hex_table[1];// 最后一位为奇数
-        return BigInteger(oss.str());
+QStringList RSA_Encryption::EncodeMessages(const QStringList &messages){
+    if(!key.IsValid()){
+        QStringList empty;
+        for(int x = 0;x < messages.size();++x)
+            empty.append(QString());
+        return empty;
+    }
+    std::vector<BigInteger> blocks;
+    std::vector<Piece> pieces;
+    for(const QString &message : messages){
+        std::string record = message.toStdString();
+        Piece piece = {blocks.size(), 0, record.size(), mode == BYTE, true};
+        SplitPlain(record, mode, blocks);
+        piece.count = blocks.size()-piece.offset;
+        pieces.push_back(piece);
     }
-    return BigInteger("F");
+    std::vector<BigInteger> cipher = EncryptBlocks(blocks);
+    QStringList result;
+    for(const Piece &piece : pieces)
+        result.append(JoinCipher(piece.length, cipher.data()+piece.offset, piece.count));
+    return result;
 }
 
 /**
- * 函数功能:判断一个数是否为素数,采用米勒拉宾大素数检测算法,失误率为(1/4)^k
- * 参数含义:num代表要判定的数,k代表测试次数
+ * 函数功能:批量解密多条消息,格式错误的密文对应空串,尚未生成或载入密钥时每条都返回空串
+ * 参数含义:messages表示密文列表,返回的明文与之一一对应
  */
-bool RSA_Encryption::IsPrime(const BigInteger &num, const unsigned k)
-{
-    assert(num != BigInteger::ZERO);// 测试num是否为0
-    if (num == BigInteger::ONE) return false;
-    if (num == BigInteger::TWO) return true;
-
-    BigInteger t = num-1;
-    BigInteger::bit b(t);// 二进制数
-    // 减一之后为奇数,原数为偶数
-    if (b.at(0) == 1) return false;
-    // num-1 = 2^s*d
-    size_t s = 0;    // 统计二进制末尾有几个0
-    BigInteger d(t);
-    for (size_t i=0; i<b.size(); ++i) {
-        if (!b.at(i)) {
-            ++s;
-            d = d.shiftRight(1);// 计算出d
-        }
-        else break;
+QStringList RSA_Encryption::DecodeMessages(const QStringList &messages){
+    if(!key.IsValid()){
+        QStringList empty;
+        for(int x = 0;x < messages.size();++x)
+            empty.append(QString());
+        return empty;
     }
-
-    for (size_t i=0; i<k; ++i) {// 测试k次
-        BigInteger a = CreateRandomSmaller(num);// 生成一个介于[1,num-1]之间的随机数a
-        BigInteger x = a.modPow(d, num);
-        if (x == BigInteger::ONE)// 可能为素数
-            continue;
-        bool ok = true;
-        // 测试所有0<=j<s,a^(2^j*d) mod num != -1
-        for (size_t j=0; j<s && ok; ++j) {
-            if (x == t)
-                ok = false;    // 有一个相等,可能为素数
-            x = x.multiply(x).mod(num);
-        }
-        // 确实都不等,一定为合数
-        if (ok) return false;
+    std::vector<BigInteger> blocks;
+    std::vector<Piece> pieces;
+    for(const QString &message : messages){
+        Piece piece = {blocks.size(), 0, 0, false, false};
+        piece.valid = SplitCipher(message, blocks, piece.length, piece.byte);
+        if(!piece.valid)
+            blocks.resize(piece.offset);    // 丢弃格式错误的密文中已经解析出的分组
+        piece.count = blocks.size()-piece.offset;
+        pieces.push_back(piece);
     }
-    return true;    // 通过所有测试,可能为素数
+    std::vector<BigInteger> plain = DecryptBlocks(blocks);
+    QStringList result;
+    for(const Piece &piece : pieces)
+        result.append(piece.valid ? JoinPlain(piece.length, piece.byte, plain.data()+piece.offset, piece.count)
+                                  : QString());
+    return result;
 }
 
 /**
- * 函数功能:随机生成一个比val小的数
- * 参数含义:val代表比较的那个数
+ * 函数功能:在线程池中加密一组分组,进度回调在当前线程上执行,因此信号仍从调用线程发出
+ * 参数含义:blocks表示明文分组
  */
-BigInteger RSA_Encryption::CreateRandomSmaller(const BigInteger &val)
-{
-    BigInteger::base_t t = 0;
-    do {
-        t = rand();
-    } while (t == 0);// 随机生成非0数
-
-    BigInteger mod(t);
-    BigInteger ans = mod%val;    // 比val要小
-    if (ans == BigInteger::ZERO)// 必须非零
-        ans = val-BigInteger::ONE;
-    return ans;
+std::vector<BigInteger> RSA_Encryption::EncryptBlocks(const std::vector<BigInteger> &blocks){
+    emit SendProgress(0.0);
+    return key.EncryptBatch(blocks, pool, [this](double progress) { emit SendProgress(progress); });
 }
 
 /**
- * 函数功能:生成一个二进制长度为len的大素数
- * 参数含义:len代表大素数的长度,k代表素数检测的次数
+ * 函数功能:在线程池中解密一组分组
+ * 参数含义:blocks表示密文分组
  */
-BigInteger RSA_Encryption::CreatePrime(unsigned int len, const unsigned int k)
-{
-    assert(k > 0);
-    BigInteger ans = CreateOddNum(len);// 首先生成一个奇数
-    while (!IsPrime(ans, k)) {// 素性检测
-        ans = ans.add(BigInteger::TWO);// 下一个奇数
+std::vector<BigInteger> RSA_Encryption::DecryptBlocks(const std::vector<BigInteger> &blocks){
+    emit SendProgress(0.0);
+    return key.DecryptBatch(blocks, pool, [this](double progress) { emit SendProgress(progress); });
+}
+
+void RSA_Encryption::SplitPlain(const std::string &record, MODE how, std::vector<BigInteger> &blocks) const{
+    const unsigned char *in = reinterpret_cast<const unsigned char*>(record.data());
+    if(how == BYTE){
+        // 每个字节单独成组
+        for(size_t x = 0;x < record.size();++x)
+            blocks.push_back(BigInteger(BigInteger::long_t(in[x])));
+        return;
     }
-    return ans;
+    // 每组打包尽可能多的字节
+    const size_t plain = key.PlainBlockBytes();
+    for(size_t x = 0;x*plain < record.size();++x)
+        blocks.push_back(BigInteger::fromBytes(in+x*plain, std::min(plain, record.size()-x*plain)));
 }
 
-/**
- * 函数功能:根据提供的欧拉数生成公钥、私钥指数
- * 参数含义:eul表示提供的欧拉数
- */
-void RSA_Encryption::CreateExponent(const BigInteger &eul)
+QString RSA_Encryption::JoinCipher(size_t length, const BigInteger *blocks, size_t count) const{
+    // 分组模式输出二进制密文的十六进制形式
+    if(mode == BLOCK)
+        return QString::fromLatin1(PackBinary(length, blocks, count).toHex().toUpper());
+    // 逐字节模式的密文以空格分隔
+    std::string ret;
+    for(size_t x = 0;x < count;++x){
+        ret += blocks[x].toString();
+        ret += " ";
+    }
+    return QString::fromStdString(ret);
+}
+
+bool RSA_Encryption::SplitCipher(const QString &message, std::vector<BigInteger> &blocks, size_t &length, bool &byte) const{
+    // 逐字节模式的密文以空格分隔,分组模式的密文是连续的十六进制串
+    byte = message.contains(' ');
+    if(!byte)
+        return UnpackBinary(QByteArray::fromHex(message.toLatin1()), blocks, length);
+    QStringList textList = message.split(" ");
+    length = textList.size()-1;    // 最后一项是结尾空格之后的空串
+    for(size_t x = 0;x < length;++x){
+        blocks.push_back(BigInteger(textList.at(int(x)).toStdString()));
+        if(blocks.back() >= key.Modulus())return false;    // 合法的密文分组小于n
+    }
+    return true;
+}
+
+QString RSA_Encryption::JoinPlain(size_t length, bool byte, const BigInteger *blocks, size_t count) const{
+    std::string ret(length, '\0');
+    unsigned char *out = reinterpret_cast<unsigned char*>(&ret[0]);
+    if(byte){
+        for(size_t x = 0;x < count;++x)
+            blocks[x].toBytes(out+x, 1);    // 明文只有一个字节
+    }
+    else{
+        const size_t plain = key.PlainBlockBytes();
+        for(size_t x = 0;x < count;++x)
+            blocks[x].toBytes(out+x*plain, std::min(plain, length-x*plain));
+    }
+    return QString::fromStdString(ret);
+}
+
+QByteArray RSA_Encryption::PackBinary(size_t length, const BigInteger *blocks, size_t count) const{
+    const size_t cipher = key.CipherBlockBytes();
+    QByteArray result(int(4+count*cipher), '\0');
+    unsigned char *out = reinterpret_cast<unsigned char*>(result.data());
+    // 明文长度,解密时用于确定最后一组的字节数
+    BigInteger(BigInteger::long_t(length)).toBytes(out, 4);
+    for(size_t x = 0;x < count;++x)
+        blocks[x].toBytes(out+4+x*cipher, cipher);
+    return result;
+}
+
+bool RSA_Encryption::UnpackBinary(const QByteArray &cipher, std::vector<BigInteger> &blocks, size_t &length) const{
+    const size_t plain = key.PlainBlockBytes(), block = key.CipherBlockBytes();
+    const size_t size = cipher.size();
+    if(size < 4 || (size-4)%block != 0)return false;
+    const unsigned char *in = reinterpret_cast<const unsigned char*>(cipher.data());
+    const size_t total = BigInteger::fromBytes(in, 4).data[0];
+    const size_t groups = (size-4)/block;
+    if(total > groups*plain || total+plain <= groups*plain)return false;
+    const size_t first = blocks.size();
+    for(size_t x = 0;x < groups;++x){
+        blocks.push_back(BigInteger::fromBytes(in+4+x*block, block));
+        if(blocks.back() >= key.Modulus()){    // 合法的密文分组小于n,不能按模n解密后当作正确结果
+            blocks.resize(first);
+            return false;
+        }
+    }
+    length = total;
+    return true;
+}
+
+QString RSA_Encryption::GetPublicKey() const
+{
+    return QString::fromStdString(key.PublicExponent().toString());
+}
+
+QString RSA_Encryption::GetPrivateKey() const
+{
+    return QString::fromStdString(key.PrivateExponent().toString());
+}
+
+bool RSA_Encryption::GenearteKey() const
 {
-    public_key = 65537;
-    private_key = public_key.modInverse(eul);
+    return key.IsValid();
 }
@@ -1,21 +1,47 @@
 #ifndef RSA_ENCRYPTION_H
 #define RSA_ENCRYPTION_H
-#include "BigInteger.h"
+#include "RSA_Key.h"
 #include <QObject>
+#include <QByteArray>
+#include <QStringList>
+#include <vector>
 
 class RSA_Encryption : public QObject
 {
     Q_OBJECT
 public:
+    enum MODE{BYTE=0,BLOCK=1};    // 逐字节加密/按分组打包加密
+
     explicit RSA_Encryption(QObject *parent = nullptr);
     ~RSA_Encryption(){}
 
     // 初始化,产生公私钥对
     void Initial(const unsigned int &length);
+    void setMode(int index);
+    // 保存或载入密钥文件,载入后无需重新生成素数即可加解密
+    bool SaveKey(const QString &path) const;
+    bool LoadKey(const QString &path);
 
     QString EncodeMessage(const QString &message);
     QString DecodeMessage(const QString &message);
 
+    // 分组模式的二进制密文:4字节明文长度(大端)+若干个与n等长的密文分组
+    QByteArray EncodeMessageBinary(const QString &message);
+    QString DecodeMessageBinary(const QByteArray &cipher);
+
+    // 批量接口:一次处理多条消息,所有分组合并后交给线程池,结果与输入一一对应
+    QStringList EncodeMessages(const QStringList &messages);
+    QStringList DecodeMessages(const QStringList &messages);
+    // 直接加解密一组分组,结果顺序与输入一致,进度通过SendProgress报告
+    std::vector<BigInteger> EncryptBlocks(const std::vector<BigInteger> &blocks);
+    std::vector<BigInteger> DecryptBlocks(const std::vector<BigInteger> &blocks);
+
+    // 用公钥加密(包装)一个不超过KeyBlockBytes字节的密钥,结果为CipherBlockBytes字节;UnwrapKey用私钥还原
+    QByteArray WrapKey(const QByteArray &secret);
+    QByteArray UnwrapKey(const QByteArray &wrapped, int length);
+    int KeyBlockBytes() const;
+    int CipherBlockBytes() const;
+
     QString GetPublicKey()const;
     QString GetPrivateKey()const;
 
@@ -23,26 +49,22 @@ public:
 signals:
     void SendProgress(double progress);
 private:
-    bool hasKey;
-    BigInteger public_key,n;
-    BigInteger private_key;
-    BigInteger p,q,eul;
-
-    /*--------------------------加密/解密--------------------*/
-    BigInteger EncryptByPublicKey(const BigInteger &key);    // 公钥加密
-    BigInteger DecryptByPrivateKey(const BigInteger &key);// 私钥解密
-
-    /*-------------------------辅助函数---------------------*/
-    // 生成一个大奇数,参数为其长度
-    BigInteger CreateOddNum(unsigned);
-    // 判断是否为素数
-    bool IsPrime(const BigInteger &, const unsigned);
-    // 随机创建一个更小的数
-    BigInteger CreateRandomSmaller(const BigInteger &);
-    // 生成一个大素数,参数为其长度
-    BigInteger CreatePrime(unsigned, const unsigned);
-    // 根据提供的欧拉数生成公钥、私钥指数
-    void CreateExponent(const BigInteger &);
+    MODE mode;
+    RSA_Key key;    // 公私钥及CRT参数
+    WorkerPool pool;    // 批量加解密使用的工作线程
+
+    /* -------------------两种模式---------------- */
+    // 按当前模式把明文切分为分组,追加到blocks末尾
+    void SplitPlain(const std::string &record, MODE how, std::vector<BigInteger> &blocks) const;
+    // 把一条消息的密文分组按当前模式输出,length为明文的字节数
+    QString JoinCipher(size_t length, const BigInteger *blocks, size_t count) const;
+    // 解析一条密文,追加其分组并返回明文字节数,格式错误时返回false
+    bool SplitCipher(const QString &message, std::vector<BigInteger> &blocks, size_t &length, bool &byte) const;
+    // 把解密后的分组还原为明文
+    QString JoinPlain(size_t length, bool byte, const BigInteger *blocks, size_t count) const;
+    // 分组模式的二进制密文
+    QByteArray PackBinary(size_t length, const BigInteger *blocks, size_t count) const;
+    bool UnpackBinary(const QByteArray &cipher, std::vector<BigInteger> &blocks, size_t &length) const;
 };
 
 #endif // RSA_ENCRYPTION_H
@@ -0,0 +1,608 @@
+#include "RSA_Key.h"
+#include "FixedBigInt.h"
+#include <assert.h>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <utility>
+#if !defined(_WIN32)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * 定长加解密路径的接口,由FixedPathImpl按模数长度实现
+ */
+struct RSA_Key::FixedPath {
+    explicit FixedPath(size_t bits): bits(bits) {}
+    virtual ~FixedPath() {}
+    virtual BigInteger Encrypt(const BigInteger &) const = 0;
+    virtual BigInteger Decrypt(const BigInteger &) const = 0;
+
+    const size_t bits;    // 模数的定长位数,输入不超过该位数时才能使用
+};
+
+/**
+ * 模数为Bits位、素数为Bits/2位时的定长实现,加解密过程不申请堆内存
+ */
+template <size_t Bits>
+struct RSA_Key::FixedPathImpl : RSA_Key::FixedPath {
+    typedef FixedBigInt<Bits> Int;
+    typedef FixedBigInt<Bits/2> Half;
+
+    FixedMontgomery<Bits> mont_n;
+    FixedMontgomery<Bits/2> mont_p, mont_q;
+    Int e;
+    Half dP, dQ, q;
+    Half qInvR;    // q^(-1)*R mod p,与差值做一次蒙哥马利乘法即得h
+
+    explicit FixedPathImpl(const RSA_Key &key)
+        : FixedPath(Bits), mont_n(key.n), mont_p(key.p), mont_q(key.q), e(key.public_key),
+          dP(key.dP), dQ(key.dQ), q(key.q), qInvR(mont_p.toMont(Half(key.qInv))) {}
+
+    BigInteger Encrypt(const BigInteger &m) const override
+    {
+        return mont_n.modPow(Int(m), e).toBigInteger();
+    }
+
+    BigInteger Decrypt(const BigInteger &c) const override
+    {
+        const Int x(c);
+        const Half m1 = mont_p.modPow(mont_p.reduce(x), dP);
+        const Half m2 = mont_q.modPow(mont_q.reduce(x), dQ);
+        // h=qInv*(m1-m2) mod p,m2可能不小于p,先约减
+        Half h = m1;
+        if (h.sub(mont_p.reduce(m2.template part<Bits>())))
+            h.add(mont_p.modulus());
+        mont_p.multiply(h, qInvR, h);
+        // ans=m2+h*q<n
+        Int ans = h.multiply(q);
+        ans.add(m2.template part<Bits>());
+        return ans.toBigInteger();
+    }
+};
+
+RSA_Key::RSA_Key(): valid(false), deterministic(false), seed(0), stream(0) {}
+
+/**
+ * 函数功能:改用固定种子生成随机数,素数搜索退化为单线程以保证结果可复现
+ * 参数含义:value表示种子
+ */
+void RSA_Key::SetSeed(uint64_t value)
+{
+    deterministic = true;
+    seed = value;
+    stream = 0;
+}
+
+/**
+ * 函数功能:生成新的公私钥对,并预先计算CRT解密参数和蒙哥马利上下文
+ * 参数含义:length表示大素数的二进制位数,progress用于报告进度(可为空)
+ */
+void RSA_Key::Generate(unsigned int length, const std::function<void(double)> &progress)
+{
+    // 没有可靠的随机数源时不生成密钥,否则素数可以被预测
+    if (!deterministic && !ChaCha20().IsSeeded()) {
+        valid = false;
+        return;
+    }
+    LimbPool::Scope scope;    // 生成结束后交还素数搜索中缓存的临时内存
+    auto report = [&](double value) { if (progress) progress(value); };
+    // 产生大素数p和q
+    report(0.1);
+    p = CreatePrime(length, 15);// 出错概率为(1/4)^15
+    report(0.4);
+    do {
+        q = CreatePrime(length, 15);
+    } while (q == p);
+    report(0.6);
+    // 计算出n
+    n = p*q;
+    mont_n = Montgomery(n);
+    // 计算出n的欧拉函数
+    eul = (p-1)*(q-1);
+    report(0.7);
+    // 设置加解密指数e和d
+    CreateExponent(eul);
+    CreateCRTParams();
+    valid = true;
+}
+
+size_t RSA_Key::PlainBlockBytes() const
+{
+    // 字节数不超过(n的二进制位数-1)/8,分组的值必然小于n
+    return std::max<size_t>((n.bitLength()-1)/8, 1);
+}
+
+size_t RSA_Key::CipherBlockBytes() const
+{
+    return n.byteLength();
+}
+
+/**
+ * 函数功能:使用公钥进行加密
+ * 参数含义:m表示要加密的明文
+ */
+BigInteger RSA_Key::Encrypt(const BigInteger &target) const
+{
+    if (fixed && target >= BigInteger::ZERO && target.bitLength() <= fixed->bits)
+        return fixed->Encrypt(target);
+    return mont_n.modPow(target, public_key);
+}
+
+/**
+ * 函数功能:使用私钥进行解密
+ * 参数含义:c表示要解密的密文
+ */
+BigInteger RSA_Key::Decrypt(const BigInteger &target) const
+{
+    BigInteger ans;
+    if (fixed && target >= BigInteger::ZERO && target.bitLength() <= fixed->bits) {
+        ans = fixed->Decrypt(target);
+    }
+    else {
+        // 分别在模p、模q下做半长度的幂运算,再用Garner公式合并
+        // h=qInv*(m1-m2) mod p,ans=m2+h*q,取模都用Barrett约减
+        ans = mont_p.modPow(target.mod(barrett_p), dP);
+        BigInteger m2 = mont_q.modPow(target.mod(barrett_q), dQ);
+        ans -= m2;
+        ans = BigInteger::mulMod(ans, qInv, barrett_p);    // 结果已在[0,p)中
+        ans *= q;
+        ans += m2;
+    }
+#ifdef RSA_CRT_SELF_CHECK
+    assert(ans == mont_n.modPow(target, private_key));// CRT结果须与直接求幂一致
+#endif
+    return ans;
+}
+
+/**
+ * 函数功能:批量公钥加密,每个分组是一个独立的任务,结果按下标写回,与输入顺序一致
+ * 参数含义:targets表示明文分组,pool表示执行加密的线程池,progress用于报告进度(在调用线程上执行)
+ */
+std::vector<BigInteger> RSA_Key::EncryptBatch(const std::vector<BigInteger> &targets, WorkerPool &pool,
+                                              const std::function<void(double)> &progress) const
+{
+    LimbPool::Scope scope;
+    std::vector<BigInteger> ans(targets.size());
+    pool.Run(targets.size(), [&](size_t i) { ans[i] = Encrypt(targets[i]); }, progress);
+    return ans;
+}
+
+/**
+ * 函数功能:批量私钥解密,与EncryptBatch相同
+ * 参数含义:targets表示密文分组,pool表示执行解密的线程池,progress用于报告进度(在调用线程上执行)
+ */
+std::vector<BigInteger> RSA_Key::DecryptBatch(const std::vector<BigInteger> &targets, WorkerPool &pool,
+                                              const std::function<void(double)> &progress) const
+{
+    LimbPool::Scope scope;
+    std::vector<BigInteger> ans(targets.size());
+    pool.Run(targets.size(), [&](size_t i) { ans[i] = Decrypt(targets[i]); }, progress);
+    return ans;
+}
+
+namespace {
+/*
+ * 密钥文件格式,整数均为大端序:
+ *   "RSAK" | 版本(1字节) | 每位的二进制位数(1字节)
+ *   n、e、d、p、q、dP、dQ、qInv,每个数为4字节长度+字节序列
+ *   模n、p、q的蒙哥马利上下文:R^2 mod m + 8字节的n',以及模p、q的Barrett mu
+ *   8字节FNV-1a校验和,覆盖前面的全部内容
+ * 预计算值与每位的宽度有关,宽度不同的程序载入时重新计算
+ */
+const char key_magic[4] = {'R', 'S', 'A', 'K'};
+const char key_version = 1;
+
+uint64_t Checksum(const std::string &data)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char ch : data) {
+        hash ^= ch;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+void PutWord(std::string &out, uint64_t value, int bytes)
+{
+    for (int i = bytes-1; i >= 0; --i)
+        out.push_back((char)(value>>(8*i)));
+}
+
+bool GetWord(const std::string &in, size_t &pos, uint64_t &value, int bytes)
+{
+    if (in.size()-pos < (size_t)bytes)
+        return false;
+    value = 0;
+    for (int i = 0; i < bytes; ++i)
+        value = (value<<8) | (unsigned char)in[pos++];
+    return true;
+}
+
+void PutNumber(std::string &out, const BigInteger &value)
+{
+    const size_t len = value.byteLength();
+    PutWord(out, len, 4);
+    out.resize(out.size()+len);
+    value.toBytes(reinterpret_cast<unsigned char*>(&out[out.size()-len]), len);
+}
+
+bool GetNumber(const std::string &in, size_t &pos, BigInteger &value)
+{
+    uint64_t len;
+    if (!GetWord(in, pos, len, 4) || in.size()-pos < len)
+        return false;
+    value = BigInteger::fromBytes(reinterpret_cast<const unsigned char*>(in.data()+pos), (size_t)len);
+    pos += (size_t)len;
+    return true;
+}
+}
+
+/**
+ * 函数功能:把密钥及全部预计算值写入二进制文件,没有密钥或写入失败时返回false。
+ *          文件以明文含有私钥和素数,POSIX系统上只允许所有者读写
+ * 参数含义:path表示文件路径
+ */
+bool RSA_Key::Save(const std::string &path) const
+{
+    if (!valid)
+        return false;
+    std::string data(key_magic, sizeof(key_magic));
+    data.push_back(key_version);
+    data.push_back((char)BigInteger::base_int);
+    for (const BigInteger *value : {&n, &public_key, &private_key, &p, &q, &dP, &dQ, &qInv})
+        PutNumber(data, *value);
+    for (const Montgomery *mont : {&mont_n, &mont_p, &mont_q}) {
+        PutNumber(data, mont->rSquare());
+        PutWord(data, mont->negInverse(), 8);
+    }
+    PutNumber(data, barrett_p.reciprocal());
+    PutNumber(data, barrett_q.reciprocal());
+    PutWord(data, Checksum(data), 8);
+
+#if defined(_WIN32)
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(data.data(), data.size());
+    file.close();
+    return !file.fail();
+#else
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0)
+        return false;
+    bool ok = ::fchmod(fd, 0600) == 0;    // 覆盖已存在的文件时收紧原来的权限
+    for (size_t written = 0; ok && written < data.size(); ) {
+        const ssize_t n = ::write(fd, data.data()+written, data.size()-written);
+        if (n < 0 && errno == EINTR)
+            continue;
+        ok = n > 0;
+        if (ok)
+            written += (size_t)n;
+    }
+    return ::close(fd) == 0 && ok;
+#endif
+}
+
+/**
+ * 函数功能:从二进制文件载入密钥。先检查校验和与各参数之间的关系,预计算值直接恢复,
+ *          不再做求逆和除法;文件由不同位宽的程序写出时才重新计算。任何检查失败时原密钥不变
+ * 参数含义:path表示文件路径
+ */
+bool RSA_Key::Load(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.size() < sizeof(key_magic)+2+8 || data.compare(0, sizeof(key_magic), key_magic, sizeof(key_magic)) != 0
+            || data[sizeof(key_magic)] != key_version)
+        return false;
+    size_t pos = data.size()-8;
+    uint64_t sum;
+    GetWord(data, pos, sum, 8);
+    data.resize(data.size()-8);
+    if (sum != Checksum(data))
+        return false;
+
+    pos = sizeof(key_magic)+2;
+    BigInteger kn, ke, kd, kp, kq, kdP, kdQ, kqInv;
+    for (BigInteger *value : {&kn, &ke, &kd, &kp, &kq, &kdP, &kdQ, &kqInv})
+        if (!GetNumber(data, pos, *value))
+            return false;
+    // 素数须为大于1的奇数,其余参数须与之相符
+    if (kp <= BigInteger::ONE || kq <= BigInteger::ONE || !(kp.data[0] & 1) || !(kq.data[0] & 1)
+            || kn != kp*kq || kdP >= kp || kdQ >= kq || kqInv >= kp || ke >= kn || kd >= kn)
+        return false;
+    // 校验和只能发现意外损坏:再检查dP、dQ由d得出,e*d≡1 (mod λ(n)),以及qInv*q≡1 (mod p)。
+    // λ(n)=lcm(p-1,q-1),e*d模p-1与q-1都余1即可
+    const BigInteger p1 = kp-BigInteger::ONE, q1 = kq-BigInteger::ONE;
+    if (kdP != kd%p1 || kdQ != kd%q1 || (ke*kdP)%p1 != BigInteger::ONE || (ke*kdQ)%q1 != BigInteger::ONE
+            || (kqInv*kq)%kp != BigInteger::ONE)
+        return false;
+
+    Montgomery mn, mp, mq;
+    Barrett bp, bq;
+    if (data[sizeof(key_magic)+1] == (char)BigInteger::base_int) {
+        BigInteger r2[3], mu[2];
+        uint64_t inv[3];
+        const BigInteger *mods[3] = {&kn, &kp, &kq};
+        for (int i = 0; i < 3; ++i) {
+            if (!GetNumber(data, pos, r2[i]) || !GetWord(data, pos, inv[i], 8) || r2[i] >= *mods[i]
+                    || (BigInteger::base_t)(mods[i]->data[0]*(BigInteger::base_t)inv[i]) != (BigInteger::base_t)0-1)
+                return false;
+        }
+        for (int i = 0; i < 2; ++i)
+            if (!GetNumber(data, pos, mu[i]) || mu[i].data.size() <= mods[i+1]->data.size())
+                return false;
+        if (pos != data.size())
+            return false;
+        mn = Montgomery(kn, r2[0], (BigInteger::base_t)inv[0]);
+        mp = Montgomery(kp, r2[1], (BigInteger::base_t)inv[1]);
+        mq = Montgomery(kq, r2[2], (BigInteger::base_t)inv[2]);
+        bp = Barrett(kp, mu[0]);
+        bq = Barrett(kq, mu[1]);
+    }
+    else {
+        mn = Montgomery(kn);
+        mp = Montgomery(kp);
+        mq = Montgomery(kq);
+        bp = Barrett(kp);
+        bq = Barrett(kq);
+    }
+
+    n = std::move(kn);
+    public_key = std::move(ke);
+    private_key = std::move(kd);
+    p = std::move(kp);
+    q = std::move(kq);
+    dP = std::move(kdP);
+    dQ = std::move(kdQ);
+    qInv = std::move(kqInv);
+    eul = (p-1)*(q-1);
+    mont_n = std::move(mn);
+    mont_p = std::move(mp);
+    mont_q = std::move(mq);
+    barrett_p = std::move(bp);
+    barrett_q = std::move(bq);
+    CreateFixedPath();
+    valid = true;
+    return true;
+}
+
+/**
+ * 函数功能:生成二进制位数不超过bits的随机数,各位直接由随机字节填满,再截掉多余的高位
+ * 参数含义:bits代表二进制位数,engine代表随机数引擎
+ */
+BigInteger RSA_Key::RandomBits(unsigned int bits, ChaCha20 &engine)
+{
+    BigInteger ans;
+    if (bits == 0)
+        return ans;
+    const size_t limbs = (bits+BigInteger::base_int-1)/BigInteger::base_int;
+    ans.data.resize(limbs);
+    engine.Fill(ans.data.data(), limbs*sizeof(BigInteger::base_t));
+    if (bits % BigInteger::base_int)
+        ans.data.back() &= ((BigInteger::base_t)1<<(bits%BigInteger::base_int))-1;
+    ans.trim();
+    return ans;
+}
+
+/**
+ * 函数功能:生成一个长度恰为length的奇数,最高两位置1,两个这样的素数之积恰为2*length位
+ * 参数含义:length代表奇数的二进制长度,engine代表随机数引擎
+ */
+BigInteger RSA_Key::CreateOddNum(unsigned int length, ChaCha20 &engine)
+{
+    if (length < 4)
+        return BigInteger("F");
+    BigInteger ans = RandomBits(length, engine);
+    ans.data.resize((length+BigInteger::base_int-1)/BigInteger::base_int, 0);// 高位可能被trim去掉
+    for (unsigned i : {length-1, length-2, 0u})
+        ans.data[i/BigInteger::base_int] |= (BigInteger::base_t)1<<(i%BigInteger::base_int);
+    return ans;
+}
+
+/**
+ * 函数功能:判断一个数是否为素数,采用米勒拉宾大素数检测算法,失误率为(1/4)^k
+ * 参数含义:num代表要判定的数,k代表测试次数,engine代表随机数引擎
+ */
+bool RSA_Key::IsPrime(const BigInteger &num, const unsigned k, ChaCha20 &engine)
+{
+    assert(num != BigInteger::ZERO);// 测试num是否为0
+    if (num == BigInteger::ONE) return false;
+    if (num == BigInteger::TWO) return true;
+
+    BigInteger t = num-1;
+    BigInteger::bit b(t);// 二进制数
+    // 减一之后为奇数,原数为偶数
+    if (b.at(0) == 1) return false;
+    // num-1 = 2^s*d
+    size_t s = 0;    // 统计二进制末尾有几个0
+    while (s < b.size() && !b.at(s))
+        ++s;
+    BigInteger d(t);
+    d >>= (unsigned)s;// 一次移位计算出d
+
+    // 所有测试共用同一个蒙哥马利上下文,x始终保持蒙哥马利形式
+    Montgomery mont(num);
+    const BigInteger one = mont.toMont(BigInteger::ONE);
+    const BigInteger minus_one = mont.toMont(t);
+    for (size_t i=0; i<k; ++i) {// 测试k次
+        BigInteger a = CreateRandomSmaller(num, engine);// 生成一个介于[1,num-1]之间的随机数a
+        BigInteger x = mont.powMont(mont.toMont(a), d);
+        if (x == one)// 可能为素数
+            continue;
+        bool ok = true;
+        // 测试所有0<=j<s,a^(2^j*d) mod num != -1
+        for (size_t j=0; j<s && ok; ++j) {
+            if (x == minus_one)
+                ok = false;    // 有一个相等,可能为素数
+            x = mont.square(x);
+        }
+        // 确实都不等,一定为合数
+        if (ok) return false;
+    }
+    return true;    // 通过所有测试,可能为素数
+}
+
+/**
+ * 函数功能:在[1,val-1]中均匀地随机取一个数,按val的位数生成后拒绝不在范围内的数,平均不超过两次
+ * 参数含义:val代表比较的那个数,engine代表随机数引擎
+ */
+BigInteger RSA_Key::CreateRandomSmaller(const BigInteger &val, ChaCha20 &engine)
+{
+    assert(val > BigInteger::ONE);
+    const unsigned bits = (unsigned)val.bitLength();
+    BigInteger ans;
+    do {
+        ans = RandomBits(bits, engine);
+    } while (ans == BigInteger::ZERO || ans >= val);
+    return ans;
+}
+
+/**
+ * 函数功能:生成一个二进制长度为len的大素数,每个线程从各自的随机起点筛选搜索,任一线程找到后其余线程退出;
+ *          固定种子时只用一个线程,保证结果可复现
+ * 参数含义:len代表大素数的长度,k代表素数检测的次数
+ */
+BigInteger RSA_Key::CreatePrime(unsigned int len, const unsigned int k)
+{
+    assert(k > 0);
+    unsigned workers = deterministic ? 1u : std::max(1u, std::thread::hardware_concurrency());
+    std::atomic<bool> found(false);
+    std::mutex lock;
+    BigInteger ans;
+    std::vector<std::thread> threads;
+    const uint64_t id = stream++;
+    for (unsigned w = 0; w < workers; ++w) {
+        threads.emplace_back([&, id]() {
+            // 每个线程使用独立的随机数引擎,默认由操作系统播种
+            ChaCha20 engine = deterministic ? ChaCha20(seed, id) : ChaCha20();
+            BigInteger prime;
+            while (!found) {
+                BigInteger start = CreateOddNum(len, engine);// 首先生成一个奇数
+                if (SearchPrimeWindow(start, k, engine, found, prime)) {
+                    std::lock_guard<std::mutex> guard(lock);
+                    if (!found) {
+                        ans = prime;
+                        found = true;
+                    }
+                }
+            }
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+    return ans;
+}
+
+/**
+ * 函数功能:在start,start+2,...组成的窗口内寻找素数,先用小素数筛掉大部分合数,
+ * 只对剩下的数做米勒拉宾检测,同时排除p-1为65537倍数的数以保证公钥指数可逆
+ * 参数含义:start代表起始奇数,k代表素数检测的次数,engine代表随机数引擎,
+ *          cancel为真时提前退出,prime传回找到的素数
+ */
+bool RSA_Key::SearchPrimeWindow(const BigInteger &start, const unsigned k, ChaCha20 &engine,
+                                       const std::atomic<bool> &cancel, BigInteger &prime)
+{
+    static const size_t window = 4096;    // 窗口内奇数的个数
+    std::vector<bool> composite(window, false);
+    // start+2i被p整除当且仅当i≡(p-r)/2 (mod p),r为start模p的余数
+    for (BigInteger::base_t p : SmallPrimes()) {
+        BigInteger::base_t r = start.modWord(p);
+        size_t i = (size_t)((BigInteger::dbl_t)((p-r)%p)*((p+1)/2)%p);
+        if (start.data.size() == 1 && start.data[0]+2*i == p)
+            i += p;    // 小素数本身不筛掉
+        for (; i < window; i += p)
+            composite[i] = true;
+    }
+    const BigInteger::base_t e = 65537;
+    BigInteger::base_t r = start.modWord(e);
+    BigInteger candidate(start);
+    size_t offset = 0;    // candidate=start+2*offset
+    for (size_t i = 0; i < window && !cancel; ++i) {
+        if (composite[i] || (r+2*i)%e == 1)
+            continue;
+        candidate += BigInteger::long_t(2*(i-offset));// 在上一个候选数上累加,不重新构造
+        offset = i;
+        if (IsPrime(candidate, k, engine)) {// 素性检测
+            prime = std::move(candidate);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * 函数功能:返回小于2^12的奇素数表,用于筛选候选数
+ */
+const std::vector<BigInteger::base_t> & RSA_Key::SmallPrimes()
+{
+    static const std::vector<BigInteger::base_t> primes = []() {
+        const size_t limit = 1<<12;
+        std::vector<bool> sieve(limit, true);
+        std::vector<BigInteger::base_t> result;
+        for (size_t i = 3; i < limit; i += 2) {
+            if (!sieve[i])
+                continue;
+            result.push_back((BigInteger::base_t)i);
+            for (size_t j = i*i; j < limit; j += 2*i)
+                sieve[j] = false;
+        }
+        return result;
+    }();
+    return primes;
+}
+
+/**
+ * 函数功能:根据提供的欧拉数生成公钥、私钥指数
+ * 参数含义:eul表示提供的欧拉数
+ */
+void RSA_Key::CreateExponent(const BigInteger &eul)
+{
+    public_key = 65537;
+#ifdef RSA_CONSTANT_TIME_INVERSE
+    private_key = public_key.modInverseConstTime(eul);// eul须保密,求逆过程不随其数值变化
+#else
+    private_key = public_key.modInverse(eul);
+#endif
+}
+
+/**
+ * 函数功能:根据p、q和私钥指数预先计算CRT解密参数及对应的蒙哥马利上下文
+ */
+void RSA_Key::CreateCRTParams()
+{
+    dP = private_key.mod(p-1);
+    dQ = private_key.mod(q-1);
+#ifdef RSA_CONSTANT_TIME_INVERSE
+    qInv = q.mod(p).modInverseConstTime(p);
+#else
+    qInv = q.modInverse(p);
+#endif
+    mont_p = Montgomery(p);
+    mont_q = Montgomery(q);
+    barrett_p = Barrett(p);
+    barrett_q = Barrett(q);
+    CreateFixedPath();
+}
+
+/**
+ * 函数功能:素数长度在(Bits/4,Bits/2]之间时使用Bits位的定长路径,
+ *          更短的素数用定长路径反而浪费,更长的素数没有对应的实例
+ */
+void RSA_Key::CreateFixedPath()
+{
+    const size_t bits = 2*std::max(p.bitLength(), q.bitLength());
+    fixed.reset();
+    if (bits > 512 && bits <= 1024)
+        fixed = std::make_shared<FixedPathImpl<1024> >(*this);
+    else if (bits > 1024 && bits <= 2048)
+        fixed = std::make_shared<FixedPathImpl<2048> >(*this);
+    else if (bits > 2048 && bits <= 4096)
+        fixed = std::make_shared<FixedPathImpl<4096> >(*this);
+}
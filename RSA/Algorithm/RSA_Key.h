@@ -0,0 +1,89 @@
+#ifndef RSA_KEY_H
+#define RSA_KEY_H
+#include "BigInteger.h"
+#include "Montgomery.h"
+#include "Barrett.h"
+#include "ChaCha20.h"
+#include "WorkerPool.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * RSA密钥:负责生成公私钥对,保存CRT解密参数与蒙哥马利上下文,并提供对单个分组的加解密。
+ * 不依赖Qt,界面层的RSA_Encryption和独立的基准测试程序共用
+ */
+class RSA_Key
+{
+public:
+    RSA_Key();
+
+    // 生成公私钥对,参数为大素数的二进制位数和进度回调;操作系统没有可靠的随机数源时不生成,IsValid()为false
+    void Generate(unsigned int length, const std::function<void(double)> &progress = nullptr);
+    bool IsValid() const { return valid; }
+    // 固定随机数种子,之后生成的密钥可以复现(单线程搜索),仅用于测试和基准
+    void SetSeed(uint64_t seed);
+    // 把密钥连同CRT参数、蒙哥马利与Barrett预计算值保存为二进制文件,或从文件载入,失败时返回false且原密钥不变。
+    // 文件不加密,含有私钥,须当作机密保管(POSIX上以0600权限创建)
+    bool Save(const std::string &path) const;
+    bool Load(const std::string &path);
+
+    const BigInteger & Modulus() const { return n; }
+    const BigInteger & PublicExponent() const { return public_key; }
+    const BigInteger & PrivateExponent() const { return private_key; }
+
+    BigInteger Encrypt(const BigInteger &) const;    // 公钥加密
+    BigInteger Decrypt(const BigInteger &) const;    // 私钥解密,使用中国剩余定理
+    // 批量加解密:各分组相互独立,由线程池并行处理,结果与输入的顺序一致
+    std::vector<BigInteger> EncryptBatch(const std::vector<BigInteger> &, WorkerPool &,
+                                         const std::function<void(double)> &progress = nullptr) const;
+    std::vector<BigInteger> DecryptBatch(const std::vector<BigInteger> &, WorkerPool &,
+                                         const std::function<void(double)> &progress = nullptr) const;
+
+    size_t PlainBlockBytes() const;    // 每个明文分组的字节数,保证分组的值小于n
+    size_t CipherBlockBytes() const;// 每个密文分组的字节数,即n的字节数
+private:
+    bool valid;
+    bool deterministic;    // 是否使用固定种子
+    uint64_t seed;    // 固定种子
+    uint64_t stream;    // 固定种子模式下下一次搜索使用的流编号
+    BigInteger public_key,n;
+    BigInteger private_key;
+    BigInteger p,q,eul;
+    BigInteger dP,dQ,qInv;    // 中国剩余定理解密参数:d mod (p-1), d mod (q-1), q^(-1) mod p
+    Montgomery mont_n;    // 模n的蒙哥马利上下文,加解密共用
+    Montgomery mont_p,mont_q;    // 模p、模q的蒙哥马利上下文,用于CRT解密
+    Barrett barrett_p,barrett_q;    // 模p、模q的Barrett上下文,用于CRT解密中的零散取模
+
+    // 模数为1024/2048/4096位时的定长加解密路径,其他长度为空,仍使用BigInteger
+    struct FixedPath;
+    template <size_t Bits> struct FixedPathImpl;
+    std::shared_ptr<const FixedPath> fixed;
+
+    /*-------------------------辅助函数---------------------*/
+    // 直接按位填充生成一个不超过给定位数的随机数
+    static BigInteger RandomBits(unsigned, ChaCha20 &);
+    // 生成一个大奇数,参数为其长度和随机数引擎
+    BigInteger CreateOddNum(unsigned, ChaCha20 &);
+    // 判断是否为素数
+    bool IsPrime(const BigInteger &, const unsigned, ChaCha20 &);
+    // 随机创建一个更小的数
+    BigInteger CreateRandomSmaller(const BigInteger &, ChaCha20 &);
+    // 生成一个大素数,参数为其长度,由多个线程并行搜索
+    BigInteger CreatePrime(unsigned, const unsigned);
+    // 在从给定奇数开始的窗口内先用小素数筛选,再对剩下的数做素性检测
+    bool SearchPrimeWindow(const BigInteger &, const unsigned, ChaCha20 &,
+                           const std::atomic<bool> &, BigInteger &);
+    // 筛选用的小素数表
+    static const std::vector<BigInteger::base_t> & SmallPrimes();
+    // 根据提供的欧拉数生成公钥、私钥指数
+    void CreateExponent(const BigInteger &);
+    // 预先计算CRT解密所需的参数
+    void CreateCRTParams();
+    // 根据素数的长度选择定长加解密路径
+    void CreateFixedPath();
+};
+
+#endif // RSA_KEY_H
@@ -0,0 +1,90 @@
+#include "WorkerPool.h"
+#include "LimbPool.h"
+#include <algorithm>
+
+/**
+ * 函数功能:创建给定数量的常驻工作线程
+ * 参数含义:threads代表线程数,0表示与CPU核数相同
+ */
+WorkerPool::WorkerPool(unsigned threads)
+    : job(nullptr), total(0), next(0), done(0), stop(false)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < threads; ++i)
+        workers.emplace_back([this]() { Work(); });
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stop = true;
+    }
+    wake.notify_all();
+    for (auto &t : workers)
+        t.join();
+}
+
+/**
+ * 函数功能:执行一批相互独立的任务,返回时全部任务都已完成。
+ *          任务只有一个或只有一个工作线程时直接在调用线程上执行
+ * 参数含义:count代表任务数,task代表以任务编号为参数的任务,progress用于报告进度(可为空)
+ */
+void WorkerPool::Run(size_t count, const std::function<void(size_t)> &task,
+                     const std::function<void(double)> &progress)
+{
+    auto report = [&](size_t finished) { if (progress) progress((double)finished/(double)count); };
+    if (count == 0)
+        return;
+    if (count == 1 || workers.size() <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            task(i);
+            report(i+1);
+        }
+        return;
+    }
+
+    std::unique_lock<std::mutex> guard(lock);
+    job = &task;
+    total = count;
+    next = 0;
+    done = 0;
+    wake.notify_all();
+    // 每完成一个任务被唤醒一次,在调用线程上报告进度
+    size_t reported = 0;
+    while (done < total) {
+        finished.wait(guard, [&]() { return done != reported; });
+        reported = done;
+        guard.unlock();
+        report(reported);
+        guard.lock();
+    }
+    job = nullptr;
+}
+
+/**
+ * 函数功能:工作线程不断领取当前批次中编号最小的未领取任务,没有任务时休眠。
+ *          本批任务领取完后交还本线程LimbPool缓存的内存,与调用线程的Scope一样以一批运算为边界
+ */
+void WorkerPool::Work()
+{
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+        wake.wait(guard, [this]() { return stop || (job && next < total); });
+        if (stop)
+            return;
+        const std::function<void(size_t)> &task = *job;
+        size_t id = next++;
+        guard.unlock();
+        task(id);
+        guard.lock();
+        ++done;
+        finished.notify_one();
+        if (next >= total) {
+            guard.unlock();
+            LimbPool::Reset();
+            guard.lock();
+        }
+    }
+}
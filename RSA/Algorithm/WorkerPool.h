@@ -0,0 +1,40 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * 常驻的工作线程池:Run把编号为0..count-1的独立任务分给各个工作线程,
+ * 调用线程等待全部完成,并在自己的线程上报告进度(便于直接转发为界面信号)。
+ * 同一时间只处理一批任务,不依赖Qt
+ */
+class WorkerPool
+{
+public:
+    explicit WorkerPool(unsigned threads = 0);    // 参数为线程数,0表示与CPU核数相同
+    ~WorkerPool();
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool & operator = (const WorkerPool &) = delete;
+
+    unsigned Size() const { return (unsigned)workers.size(); }
+    // 执行一批任务,task的参数为任务编号,progress报告已完成的比例(可为空)
+    void Run(size_t count, const std::function<void(size_t)> &task,
+             const std::function<void(double)> &progress = nullptr);
+private:
+    std::vector<std::thread> workers;
+    std::mutex lock;
+    std::condition_variable wake;    // 通知工作线程有新任务或需要退出
+    std::condition_variable finished;    // 通知调用线程有任务完成
+    const std::function<void(size_t)> *job;    // 当前这批任务,为空时没有任务
+    size_t total;    // 任务总数
+    size_t next;    // 下一个待领取的任务编号
+    size_t done;    // 已完成的任务数
+    bool stop;    // 线程池析构时置为真
+
+    void Work();    // 工作线程的主循环
+};
+
+#endif // WORKERPOOL_H
@@ -0,0 +1,40 @@
+#-------------------------------------------------
+#
+# BigInteger benchmark and regression checks (no Qt needed)
+#
+#-------------------------------------------------
+
+QT       -= core gui
+CONFIG   += console c++14 thread
+CONFIG   -= app_bundle qt
+
+TARGET = Benchmark
+TEMPLATE = app
+
+INCLUDEPATH += ../Algorithm
+
+# ChaCha20 reads its seed from RtlGenRandom.
+win32: LIBS += -ladvapi32
+
+SOURCES += \
+        main.cpp \
+        Reference.cpp \
+    ../Algorithm/Barrett.cpp \
+    ../Algorithm/BigInteger.cpp \
+    ../Algorithm/ChaCha20.cpp \
+    ../Algorithm/LimbPool.cpp \
+    ../Algorithm/Montgomery.cpp \
+    ../Algorithm/RSA_Key.cpp \
+    ../Algorithm/WorkerPool.cpp
+
+HEADERS += \
+        Reference.h \
+    ../Algorithm/Barrett.h \
+    ../Algorithm/BigInteger.h \
+    ../Algorithm/ChaCha20.h \
+    ../Algorithm/FixedBigInt.h \
+    ../Algorithm/InlineVector.h \
+    ../Algorithm/LimbPool.h \
+    ../Algorithm/Montgomery.h \
+    ../Algorithm/RSA_Key.h \
+    ../Algorithm/WorkerPool.h
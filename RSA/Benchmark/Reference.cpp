@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <cassert>
+#include "Reference.h"
+
+/**
+ * 函数功能:利用单个位的数构造参考大整数
+ * 参数含义:val代表给定的数
+ */
+RefInteger::RefInteger(uint32_t val) {
+    if (val)
+        data.push_back(val);
+}
+
+/**
+ * 函数功能:由十六进制字符串构造参考大整数,每个字符依次乘16累加
+ * 参数含义:str代表十六进制字符串,不带符号
+ */
+RefInteger RefInteger::fromHex(const std::string & str) {
+    RefInteger ans;
+    for (char ch : str) {
+        uint32_t num = 0;
+        if (ch>='0' && ch<='9')
+            num = ch-'0';
+        else if (ch>='a' && ch<='f')
+            num = ch-'a'+10;
+        else if (ch>='A' && ch<='F')
+            num = ch-'A'+10;
+        else
+            assert(false);
+        // ans=ans*16+num
+        uint64_t carry = num;
+        for (size_t i=0; i<ans.data.size(); ++i) {
+            carry += (uint64_t)ans.data[i]<<4;
+            ans.data[i] = (uint32_t)carry;
+            carry >>= 32;
+        }
+        if (carry)
+            ans.data.push_back((uint32_t)carry);
+    }
+    ans.trim();
+    return ans;
+}
+
+/**
+ * 函数功能:转换为大写的十六进制字符串
+ */
+std::string RefInteger::toHex() const {
+    static const char hex_table[] = "0123456789ABCDEF";
+    std::string ans;
+    for (size_t i=data.size(); i-->0; )
+        for (int j=28; j>=0; j-=4)
+            ans.push_back(hex_table[(data[i]>>j) & 0xf]);
+    size_t pos = ans.find_first_not_of('0');
+    return pos==std::string::npos ? "0" : ans.substr(pos);
+}
+
+/**
+ * 函数功能:返回二进制位数,0的位数为0
+ */
+size_t RefInteger::bitLength() const {
+    if (data.empty())
+        return 0;
+    size_t ans = (data.size()-1)*32;
+    for (uint32_t t=data.back(); t; t>>=1)
+        ++ans;
+    return ans;
+}
+
+/**
+ * 函数功能:检测第id位二进制是否为1
+ * 参数含义:id代表第id位
+ */
+bool RefInteger::testBit(size_t id) const {
+    if (id/32 >= data.size())
+        return false;
+    return (data[id/32]>>(id%32)) & 1;
+}
+
+/**
+ * 函数功能:比较两个参考大整数
+ * 参数含义:val代表要与之比较的数
+ */
+int RefInteger::compare(const RefInteger & val) const {
+    if (data.size() != val.data.size())
+        return data.size()<val.data.size() ? -1 : 1;
+    for (size_t i=data.size(); i-->0; )
+        if (data[i] != val.data[i])
+            return data[i]<val.data[i] ? -1 : 1;
+    return 0;
+}
+
+/**
+ * 函数功能:加法
+ * 参数含义:val代表加数
+ */
+RefInteger RefInteger::add(const RefInteger & val) const {
+    RefInteger ans;
+    size_t n = std::max(data.size(), val.data.size());
+    ans.data.resize(n+1);
+    uint64_t carry = 0;
+    for (size_t i=0; i<n; ++i) {
+        if (i < data.size())
+            carry += data[i];
+        if (i < val.data.size())
+            carry += val.data[i];
+        ans.data[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    ans.data[n] = (uint32_t)carry;
+    ans.trim();
+    return ans;
+}
+
+/**
+ * 函数功能:减法,被减数必须不小于减数
+ * 参数含义:val代表减数
+ */
+RefInteger RefInteger::subtract(const RefInteger & val) const {
+    assert(compare(val) >= 0);
+    RefInteger ans(*this);
+    int64_t borrow = 0;
+    for (size_t i=0; i<ans.data.size(); ++i) {
+        int64_t diff = (int64_t)ans.data[i]-borrow-(i<val.data.size() ? val.data[i] : 0);
+        borrow = diff < 0;
+        ans.data[i] = (uint32_t)(diff+(borrow<<32));
+    }
+    ans.trim();
+    return ans;
+}
+
+/**
+ * 函数功能:竖式乘法
+ * 参数含义:val代表乘数
+ */
+RefInteger RefInteger::multiply(const RefInteger & val) const {
+    RefInteger ans;
+    if (isZero() || val.isZero())
+        return ans;
+    ans.data.assign(data.size()+val.data.size(), 0);
+    for (size_t i=0; i<data.size(); ++i) {
+        uint64_t carry = 0;
+        for (size_t j=0; j<val.data.size(); ++j) {
+            carry += (uint64_t)data[i]*val.data[j]+ans.data[i+j];
+            ans.data[i+j] = (uint32_t)carry;
+            carry >>= 32;
+        }
+        ans.data[i+val.data.size()] = (uint32_t)carry;
+    }
+    ans.trim();
+    return ans;
+}
+
+/**
+ * 函数功能:从最高位开始逐位移入被除数,能减则减,得到商和余数
+ * 参数含义:val代表除数,m传回余数
+ */
+RefInteger RefInteger::divideAndRemainder(const RefInteger & val, RefInteger & m) const {
+    assert(!val.isZero());
+    RefInteger ans, rem;
+    const size_t bits = bitLength();
+    ans.data.assign((bits+31)/32, 0);
+    for (size_t i=bits; i-->0; ) {
+        rem.shiftLeftOne();
+        if (testBit(i)) {
+            if (rem.data.empty())
+                rem.data.push_back(0);
+            rem.data[0] |= 1;
+        }
+        if (rem.compare(val) >= 0) {
+            rem = rem.subtract(val);
+            ans.data[i/32] |= (uint32_t)1<<(i%32);
+        }
+    }
+    ans.trim();
+    m = rem;
+    return ans;
+}
+
+/**
+ * 函数功能:取余
+ * 参数含义:m代表模数
+ */
+RefInteger RefInteger::mod(const RefInteger & m) const {
+    RefInteger rem;
+    divideAndRemainder(m, rem);
+    return rem;
+}
+
+/**
+ * 函数功能:从指数的最低位开始的平方乘算法求幂模
+ * 参数含义:exponent代表指数,m代表模数
+ */
+RefInteger RefInteger::modPow(const RefInteger & exponent, const RefInteger & m) const {
+    RefInteger ans = RefInteger(1).mod(m);
+    RefInteger base = mod(m);
+    for (size_t i=0; i<exponent.bitLength(); ++i) {
+        if (exponent.testBit(i))
+            ans = ans.multiply(base).mod(m);
+        base = base.multiply(base).mod(m);
+    }
+    return ans;
+}
+
+/**
+ * 函数功能:辗转相除求最大公约数
+ * 参数含义:val代表另一个数
+ */
+RefInteger RefInteger::gcd(const RefInteger & val) const {
+    RefInteger a(*this), b(val);
+    while (!b.isZero()) {
+        RefInteger t = a.mod(b);
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/**
+ * 函数功能:去掉高位无用的0
+ */
+void RefInteger::trim() {
+    while (!data.empty() && data.back()==0)
+        data.pop_back();
+}
+
+/**
+ * 函数功能:左移一位
+ */
+void RefInteger::shiftLeftOne() {
+    uint32_t carry = 0;
+    for (size_t i=0; i<data.size(); ++i) {
+        uint32_t t = data[i];
+        data[i] = (t<<1) | carry;
+        carry = t>>31;
+    }
+    if (carry)
+        data.push_back(carry);
+}
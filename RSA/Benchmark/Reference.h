@@ -0,0 +1,38 @@
+#ifndef REFERENCE_H
+#define REFERENCE_H
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * 用于交叉校验的参考大整数实现:只处理非负数,每位32个二进制位,
+ * 全部采用最直接的竖式算法和逐位试减的除法,不追求速度,只求容易确认正确
+ */
+class RefInteger {
+public:
+    RefInteger() {}    // 默认为0
+    explicit RefInteger(uint32_t);    // 利用单个位的数初始化
+
+    static RefInteger fromHex(const std::string &);// 由十六进制字符串构造
+    std::string toHex() const;    // 转换为大写十六进制字符串,0为"0"
+
+    bool isZero() const { return data.empty(); }
+    size_t bitLength() const;    // 二进制位数
+    bool testBit(size_t) const;    // 第i位二进制是否为1
+    int compare(const RefInteger &) const;    // 比较,-1、0、1分别表示小于、等于、大于
+
+    RefInteger add(const RefInteger &) const;    // 加法
+    RefInteger subtract(const RefInteger &) const;// 减法,要求被减数不小于减数
+    RefInteger multiply(const RefInteger &) const;// 竖式乘法
+    RefInteger divideAndRemainder(const RefInteger &, RefInteger &) const;// 逐位试减的除法,余数由参数传回
+    RefInteger mod(const RefInteger &) const;    // 取余
+    RefInteger modPow(const RefInteger &, const RefInteger &) const;// 从低位开始的平方乘算法
+    RefInteger gcd(const RefInteger &) const;    // 辗转相除求最大公约数
+private:
+    std::vector<uint32_t> data;    // 按位存储,低位在前,没有多余的高位0
+
+    void trim();    // 去掉高位的0
+    void shiftLeftOne();    // 左移一位
+};
+
+#endif // REFERENCE_H
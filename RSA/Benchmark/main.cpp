@@ -0,0 +1,334 @@
+/**
+ * BigInteger基准测试与回归检查,不依赖Qt。
+ * 对256/512/1024/2048/4096位的数分别测量乘法、平方、除法、Barrett约减、奇偶模数的幂模、求逆元、
+ * 十六进制与十进制的解析和输出、字节数组导入导出、达到Toom-3阈值的乘法与平方、定长整数的乘法与幂模、完整的密钥生成、密钥文件载入以及逐个与批量解密,输出每秒运算次数、每次运算的堆内存申请次数和LimbPool命中次数,
+ * 同时用参考实现RefInteger校验结果,任一校验失败时返回非0。
+ * 用法:Benchmark [每项最短测量时间(毫秒),默认300] [最大位数,默认4096]
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include "Barrett.h"
+#include "BigInteger.h"
+#include "FixedBigInt.h"
+#include "LimbPool.h"
+#include "RSA_Key.h"
+#include "WorkerPool.h"
+#include "Reference.h"
+
+// 统计堆内存申请次数,替换全局的operator new
+static std::atomic<size_t> allocations(0);
+
+void * operator new(size_t size) {
+    ++allocations;
+    if (void * p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void * operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void * p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void * p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void * p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void * p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+struct Measure {
+    double ops_per_sec;    // 每秒运算次数
+    double allocs_per_op;    // 每次运算的堆内存申请次数
+    double pool_hits_per_op;    // 每次运算从LimbPool空闲表取出内存的次数,这些申请不经过operator new
+};
+
+double min_seconds = 0.3;    // 每项的最短测量时间
+int failures = 0;    // 校验失败的次数
+std::mt19937_64 engine(20180611);    // 固定种子,保证每次运行的数据相同
+volatile size_t sink = 0;    // 防止运算结果被优化掉
+
+/**
+ * 函数功能:反复执行f直到总时间不少于min_seconds,返回平均速度和内存申请次数
+ * 参数含义:f代表要测量的运算,once为真时只执行一次(用于耗时很长的密钥生成)
+ */
+template <typename F>
+Measure Run(F f, bool once = false) {
+    typedef std::chrono::steady_clock clock;
+    size_t total = 0, batch = 1;
+    double elapsed = 0;
+    size_t allocs = 0;
+    LimbPool::ClearStats();
+    while (true) {
+        size_t before = allocations;
+        clock::time_point start = clock::now();
+        for (size_t i=0; i<batch; ++i)
+            f();
+        elapsed += std::chrono::duration<double>(clock::now()-start).count();
+        allocs += allocations-before;
+        total += batch;
+        if (once || elapsed >= min_seconds)
+            break;
+        batch *= 2;
+    }
+    Measure ans = {total/elapsed, (double)allocs/total, (double)LimbPool::Stats().hits/total};
+    return ans;
+}
+
+/**
+ * 函数功能:生成给定二进制长度的随机十六进制串,最高位为1
+ * 参数含义:bits代表二进制位数,odd为真时最低位为1
+ */
+std::string RandomHex(size_t bits, bool odd = false) {
+    static const char hex_table[] = "0123456789ABCDEF";
+    std::string ans((bits+3)/4, '0');
+    for (size_t i=0; i<ans.size(); ++i)
+        ans[i] = hex_table[engine()%16];
+    size_t top = (bits-1)%4;    // 最高的十六进制位中最高二进制位的位置
+    ans[0] = hex_table[((engine()%16) & ((1u<<top)-1)) | (1u<<top)];
+    if (odd && bits > 4)
+        ans.back() = hex_table[(engine()%8)*2+1];
+    return ans;
+}
+
+/**
+ * 函数功能:输出一行测量结果,并记录校验结果
+ * 参数含义:name代表运算名称,bits代表位数,m代表测量结果,ok代表校验是否通过
+ */
+void Report(const char * name, size_t bits, const Measure & m, bool ok) {
+    std::printf("%-20s %6zu %16.1f %12.2f %12.2f   %s\n", name, bits, m.ops_per_sec, m.allocs_per_op,
+                m.pool_hits_per_op, ok ? "ok" : "FAILED");
+    if (!ok)
+        ++failures;
+}
+
+bool Same(const BigInteger & a, const RefInteger & b) {
+    return a.toString() == b.toHex();
+}
+
+void BenchArithmetic(size_t bits) {
+    const std::string ha = RandomHex(bits), hb = RandomHex(bits), hm = RandomHex(bits, true);
+    const std::string he = RandomHex(bits), hd = RandomHex(2*bits);
+    BigInteger a(ha), b(hb), m(hm), e(he), d(hd);
+    RefInteger ra = RefInteger::fromHex(ha), rb = RefInteger::fromHex(hb);
+    RefInteger rm = RefInteger::fromHex(hm), re = RefInteger::fromHex(he), rd = RefInteger::fromHex(hd);
+
+    BigInteger r;
+    Measure t = Run([&]() { r = a.multiply(b); });
+    Report("multiply", bits, t, Same(r, ra.multiply(rb)));
+
+    t = Run([&]() { r = a.square(); });
+    Report("square", bits, t, Same(r, ra.multiply(ra)));
+
+    // 2*bits位的数除以bits位的数
+    BigInteger q, rem;
+    t = Run([&]() { q = d.divideAndRemainder(b, rem); });
+    RefInteger rrem, rq = rd.divideAndRemainder(rb, rrem);
+    Report("divideAndRemainder", bits, t, Same(q, rq) && Same(rem, rrem));
+
+    // 同一模数的约减与模乘
+    const Barrett red(m);
+    t = Run([&]() { r = d.mod(red); });
+    Report("Barrett mod", bits, t, Same(r, rd.mod(rm)));
+
+    const BigInteger am = a.mod(m), bm = b.mod(m);
+    t = Run([&]() { r = BigInteger::mulMod(am, bm, red); });
+    Report("mulMod", bits, t, Same(r, ra.mod(rm).multiply(rb.mod(rm)).mod(rm)));
+
+    // 参考实现很慢,较长的数只校验较短的指数
+    auto checkPow = [&](const BigInteger & r, const BigInteger & m, const RefInteger & rm) {
+        if (bits <= 1024)
+            return Same(r, ra.modPow(re, rm));
+        const std::string hs = RandomHex(128);
+        return Same(a.modPow(BigInteger(hs), m), ra.modPow(RefInteger::fromHex(hs), rm));
+    };
+    t = Run([&]() { r = a.modPow(e, m); });
+    Report("modPow", bits, t, checkPow(r, m, rm));
+
+    // 偶数模数不能用蒙哥马利模乘,走Barrett约减的滑动窗口
+    std::string hv = hm;
+    --hv.back();    // 奇数的十六进制末位减1即为偶数
+    const BigInteger v(hv);
+    const RefInteger rv = RefInteger::fromHex(hv);
+    t = Run([&]() { r = a.modPow(e, v); });
+    Report("modPow even", bits, t, checkPow(r, v, rv));
+
+    // a<m时求a在模m下的逆元,逆元不存在时modInverse返回0
+    BigInteger x = a.mod(m);
+    t = Run([&]() { r = x.modInverse(m); });
+    RefInteger rx = ra.mod(rm);
+    bool ok;
+    if (r.equals(BigInteger::ZERO))
+        ok = rx.gcd(rm).compare(RefInteger(1)) != 0;
+    else
+        ok = rx.multiply(RefInteger::fromHex(r.toString())).mod(rm).compare(RefInteger(1)) == 0;
+    Report("modInverse", bits, t, ok);
+
+    BigInteger ct;
+    t = Run([&]() { ct = x.modInverseConstTime(m); });
+    // 常数时间版本与modInverse结果相同,并且确实是逆元
+    if (ct.equals(BigInteger::ZERO))
+        ok = r.equals(BigInteger::ZERO);
+    else
+        ok = ct.equals(r) && rx.multiply(RefInteger::fromHex(ct.toString())).mod(rm).compare(RefInteger(1)) == 0;
+    Report("modInverseConstTime", bits, t, ok);
+
+    t = Run([&]() { r = BigInteger(ha); });
+    Report("hex parse", bits, t, Same(r, ra));
+
+    std::string s;
+    t = Run([&]() { s = a.toString(); sink += s.size(); });
+    Report("toString", bits, t, s == ra.toHex());
+
+    // 十进制没有参考实现,检查往返转换
+    t = Run([&]() { s = a.toDecimal(); sink += s.size(); });
+    Report("toDecimal", bits, t, BigInteger::fromDecimal(s).equals(a));
+
+    const std::string dec = s;
+    t = Run([&]() { r = BigInteger::fromDecimal(dec); });
+    Report("fromDecimal", bits, t, Same(r, ra));
+
+    std::vector<unsigned char> bytes(a.byteLength());
+    t = Run([&]() { a.toBytes(bytes.data(), bytes.size()); });
+    Report("toBytes", bits, t, BigInteger::fromBytes(bytes.data(), bytes.size()).equals(a));
+
+    t = Run([&]() { r = BigInteger::fromBytes(bytes.data(), bytes.size()); });
+    Report("fromBytes", bits, t, Same(r, ra));
+}
+
+/**
+ * 函数功能:测量达到Toom-3阈值的乘法与平方,阈值远大于默认的最大位数,不受命令行参数限制。
+ *          3*阈值+1位时三等分后的各段仍不小于阈值,覆盖递归和段长不等的情形;2:1的乘法是Toom-3的长度比上限
+ */
+void BenchToom3() {
+    const size_t sizes[] = {BigInteger::toom3_threshold, 3*BigInteger::toom3_threshold+1};
+    for (size_t limbs : sizes) {
+        const size_t bits = limbs*BigInteger::base_int;
+        const std::string ha = RandomHex(2*bits), hb = RandomHex(bits);
+        const BigInteger a(ha.substr(0, ha.size()/2)), b(hb), c(ha);
+        const RefInteger ra = RefInteger::fromHex(ha.substr(0, ha.size()/2)), rb = RefInteger::fromHex(hb);
+        const RefInteger rc = RefInteger::fromHex(ha);
+
+        BigInteger r;
+        Measure t = Run([&]() { r = a.multiply(b); });
+        Report("Toom-3 multiply", bits, t, Same(r, ra.multiply(rb)));
+
+        t = Run([&]() { r = a.square(); });
+        Report("Toom-3 square", bits, t, Same(r, ra.multiply(ra)));
+
+        t = Run([&]() { r = c.multiply(b); });
+        Report("Toom-3 multiply 2:1", 2*bits, t, Same(r, rc.multiply(rb)));
+    }
+}
+
+/**
+ * 函数功能:测量定长整数的乘法与幂模,结果与BigInteger对照
+ */
+template <size_t Bits>
+void BenchFixed() {
+    const std::string ha = RandomHex(Bits), hb = RandomHex(Bits), hm = RandomHex(Bits, true);
+    const std::string he = RandomHex(Bits);
+    BigInteger a(ha), b(hb), m(hm), e(he);
+    const FixedBigInt<Bits> fa(a), fb(b), fe(e);
+    const FixedMontgomery<Bits> mont(m);
+
+    FixedBigInt<2*Bits> prod;
+    Measure t = Run([&]() { prod = fa.multiply(fb); });
+    Report("fixed multiply", Bits, t, prod.toBigInteger().equals(a.multiply(b)));
+
+    FixedBigInt<Bits> r;
+    t = Run([&]() { r = mont.modPow(fa, fe); });
+    Report("fixed modPow", Bits, t, r.toBigInteger().equals(a.modPow(e, m)));
+}
+
+void BenchKeyGeneration(size_t bits) {
+    RSA_Key key;
+    key.SetSeed(bits);    // 固定种子,每次运行生成相同的密钥,耗时可以比较
+    Measure t = Run([&]() { key.Generate((unsigned)bits/2); }, true);
+    // 素数的最高两位为1,模数恰为bits位;再用参考实现验证加密,用解密还原
+    const BigInteger & n = key.Modulus();
+    bool ok = key.IsValid() && n.toString().size() == bits/4;
+    const std::string hm = RandomHex(n.toString().size()*4-8);
+    BigInteger c = key.Encrypt(BigInteger(hm));
+    RefInteger rc = RefInteger::fromHex(hm).modPow(RefInteger::fromHex(key.PublicExponent().toString()),
+                                                  RefInteger::fromHex(n.toString()));
+    ok = ok && Same(c, rc) && key.Decrypt(c).toString() == BigInteger(hm).toString();
+    Report("keygen", bits, t, ok);
+
+    // 从密钥文件载入,预计算值直接恢复,载入的密钥须能解开原密钥加密的数据
+    const char * path = "Benchmark.key";
+    RSA_Key loaded;
+    ok = key.Save(path);
+    t = Run([&]() { ok = loaded.Load(path) && ok; });
+    std::remove(path);
+    Report("key load", bits, t, ok && loaded.Decrypt(c).equals(key.Decrypt(c)));
+
+    // 同一批密文逐个解密与交给线程池批量解密,按分组数折算为每秒解密的分组数
+    std::vector<BigInteger> message, cipher;
+    for (size_t i=0; i<16; ++i) {
+        message.push_back(BigInteger(RandomHex(n.bitLength()-8)));
+        cipher.push_back(key.Encrypt(message.back()));
+    }
+    std::vector<BigInteger> plain(cipher.size());
+    t = Run([&]() { for (size_t i=0; i<cipher.size(); ++i) plain[i] = key.Decrypt(cipher[i]); });
+    t.ops_per_sec *= cipher.size();
+    t.allocs_per_op /= cipher.size();
+    t.pool_hits_per_op /= cipher.size();
+    ok = true;
+    for (size_t i=0; ok && i<plain.size(); ++i)
+        ok = plain[i].equals(message[i]);
+    Report("decrypt", bits, t, ok);
+    static WorkerPool pool;
+    std::vector<BigInteger> batch;
+    t = Run([&]() { batch = key.DecryptBatch(cipher, pool); });
+    t.ops_per_sec *= cipher.size();
+    t.allocs_per_op /= cipher.size();
+    t.pool_hits_per_op /= cipher.size();
+    ok = batch.size() == plain.size();
+    for (size_t i=0; ok && i<batch.size(); ++i)
+        ok = batch[i].equals(message[i]);
+    Report("decrypt batch", bits, t, ok);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    size_t max_bits = 4096;
+    if (argc > 1)
+        min_seconds = std::atof(argv[1])/1000.0;
+    if (argc > 2)
+        max_bits = std::strtoul(argv[2], nullptr, 10);
+
+    std::printf("%-20s %6s %16s %12s %12s   %s\n", "operation", "bits", "ops/sec", "allocs/op", "pool hits/op", "check");
+    for (size_t bits=256; bits<=max_bits; bits*=2)
+        BenchArithmetic(bits);
+    BenchToom3();
+    if (max_bits >= 1024)
+        BenchFixed<1024>();
+    if (max_bits >= 2048)
+        BenchFixed<2048>();
+    if (max_bits >= 4096)
+        BenchFixed<4096>();
+    for (size_t bits=256; bits<=max_bits; bits*=2)
+        BenchKeyGeneration(bits);
+    if (failures)
+        std::printf("%d check(s) FAILED\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,47 @@
+#-------------------------------------------------
+#
+# Headless RSA-hybrid file encryption tool (Qt core only)
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+CONFIG   += console c++14 thread
+CONFIG   -= app_bundle
+
+TARGET = FileCrypt
+TEMPLATE = app
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += ../Algorithm
+
+# ChaCha20 reads its seed from RtlGenRandom.
+win32: LIBS += -ladvapi32
+
+SOURCES += \
+        main.cpp \
+        HybridFile.cpp \
+    ../Algorithm/Barrett.cpp \
+    ../Algorithm/BigInteger.cpp \
+    ../Algorithm/ChaCha20.cpp \
+    ../Algorithm/LimbPool.cpp \
+    ../Algorithm/Montgomery.cpp \
+    ../Algorithm/Poly1305.cpp \
+    ../Algorithm/RSA_Encryption.cpp \
+    ../Algorithm/RSA_Key.cpp \
+    ../Algorithm/WorkerPool.cpp
+
+HEADERS += \
+        HybridFile.h \
+    ../Algorithm/Barrett.h \
+    ../Algorithm/BigInteger.h \
+    ../Algorithm/ChaCha20.h \
+    ../Algorithm/FixedBigInt.h \
+    ../Algorithm/InlineVector.h \
+    ../Algorithm/LimbPool.h \
+    ../Algorithm/Montgomery.h \
+    ../Algorithm/Poly1305.h \
+    ../Algorithm/RSA_Encryption.h \
+    ../Algorithm/RSA_Key.h \
+    ../Algorithm/WorkerPool.h
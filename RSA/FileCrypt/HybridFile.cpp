@@ -0,0 +1,192 @@
+#include "HybridFile.h"
+#include "ChaCha20.h"
+#include "Poly1305.h"
+#include <QFile>
+#include <algorithm>
+#include <vector>
+
+namespace {
+const char file_magic[4] = {'R', 'S', 'A', 'F'};
+const char file_version = 1;
+const int header_bytes = 24;    // 包装后的密钥之前的固定部分
+const int tag_bytes = 16;
+const int session_bytes = 32;    // ChaCha20密钥长度
+const uint32_t min_chunk = 64;
+const uint32_t max_chunk = 64u<<20;    // 块大小来自文件头,解密前先限制缓冲区大小
+
+void PutWord(unsigned char *out, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+        out[i] = (unsigned char)(value>>(8*(bytes-1-i)));
+}
+
+uint64_t GetWord(const unsigned char *in, int bytes)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i)
+        value = (value<<8) | in[i];
+    return value;
+}
+
+/**
+ * 函数功能:计算一个块的认证码。0号分组的密钥流作为Poly1305密钥,
+ *          消息为密文后接小端序的块长度、块序号和最后一块标志
+ * 参数含义:key代表会话密钥,index代表块序号,last代表是否为最后一块,cipher、len代表密文,tag传回认证码
+ */
+void ChunkTag(const uint32_t key[8], uint64_t index, bool last, const unsigned char *cipher, size_t len,
+              unsigned char tag[16])
+{
+    uint32_t block[16];
+    unsigned char one_time[32];
+    ChaCha20::Block(key, 0, index, block);
+    for (int i = 0; i < 8; ++i)
+        for (int j = 0; j < 4; ++j)
+            one_time[4*i+j] = (unsigned char)(block[i]>>(8*j));
+    Poly1305 mac(one_time);
+    mac.Update(cipher, len);
+    unsigned char trailer[17];
+    for (int i = 0; i < 8; ++i) {
+        trailer[i] = (unsigned char)((uint64_t)len>>(8*i));
+        trailer[8+i] = (unsigned char)(index>>(8*i));
+    }
+    trailer[16] = last ? 1 : 0;
+    mac.Update(trailer, sizeof(trailer));
+    mac.Final(tag);
+}
+}
+
+HybridFile::HybridFile(RSA_Encryption &rsa, uint32_t chunk): rsa(rsa), chunk(std::min(std::max(chunk, min_chunk), max_chunk)) {}
+
+bool HybridFile::Fail(const QString &reason)
+{
+    error = reason;
+    return false;
+}
+
+/**
+ * 函数功能:生成会话密钥并用RSA包装,之后逐块映射输入、加密并追加认证码
+ * 参数含义:input表示明文文件,output表示密文文件
+ */
+bool HybridFile::Encrypt(const QString &input, const QString &output)
+{
+    if (!rsa.GenearteKey())
+        return Fail(QString::fromUtf8("尚未生成或载入密钥"));
+    if (rsa.KeyBlockBytes() < session_bytes)
+        return Fail(QString::fromUtf8("RSA密钥太短,无法包装32字节的会话密钥"));
+    ChaCha20 random;
+    if (!random.IsSeeded())
+        return Fail(QString::fromUtf8("没有可靠的随机数源,无法生成会话密钥"));
+    QFile in(input), out(output);
+    if (!in.open(QIODevice::ReadOnly))
+        return Fail(QString::fromUtf8("无法打开输入文件:")+in.errorString());
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return Fail(QString::fromUtf8("无法创建输出文件:")+out.errorString());
+
+    // 整个RSA明文分组都填入随机数,前32字节作为会话密钥
+    QByteArray secret(rsa.KeyBlockBytes(), '\0');
+    random.Fill(secret.data(), secret.size());
+    const QByteArray wrapped = rsa.WrapKey(secret);
+    uint32_t key[8];
+    ChaCha20::LoadKey(reinterpret_cast<const unsigned char*>(secret.constData()), key);
+
+    const uint64_t total = in.size();
+    unsigned char header[header_bytes];
+    std::copy(file_magic, file_magic+4, header);
+    header[4] = file_version;
+    header[5] = header[6] = header[7] = 0;
+    PutWord(header+8, chunk, 4);
+    PutWord(header+12, total, 8);
+    PutWord(header+20, wrapped.size(), 4);
+    if (out.write(reinterpret_cast<const char*>(header), header_bytes) != header_bytes
+            || out.write(wrapped) != wrapped.size()) {
+        out.remove();
+        return Fail(QString::fromUtf8("写入失败:")+out.errorString());
+    }
+
+    const uint64_t chunks = std::max<uint64_t>(1, (total+chunk-1)/chunk);
+    std::vector<unsigned char> buffer(chunk+tag_bytes);
+    for (uint64_t i = 0; i < chunks; ++i) {
+        const uint64_t offset = i*chunk;
+        const size_t len = (size_t)std::min<uint64_t>(chunk, total-offset);
+        if (len) {
+            uchar *src = in.map(offset, len);
+            if (!src) {
+                out.remove();
+                return Fail(QString::fromUtf8("无法映射输入文件:")+in.errorString());
+            }
+            ChaCha20::Crypt(key, i, 1, src, buffer.data(), len);
+            in.unmap(src);
+        }
+        ChunkTag(key, i, i+1 == chunks, buffer.data(), len, buffer.data()+len);
+        if (out.write(reinterpret_cast<const char*>(buffer.data()), len+tag_bytes) != qint64(len+tag_bytes)) {
+            out.remove();
+            return Fail(QString::fromUtf8("写入失败:")+out.errorString());
+        }
+        if (progress)
+            progress((double)(i+1)/(double)chunks);
+    }
+    return true;
+}
+
+/**
+ * 函数功能:解开会话密钥,逐块映射输入,先校验认证码再解密写出
+ * 参数含义:input表示密文文件,output表示明文文件
+ */
+bool HybridFile::Decrypt(const QString &input, const QString &output)
+{
+    if (!rsa.GenearteKey())
+        return Fail(QString::fromUtf8("尚未生成或载入密钥"));
+    QFile in(input), out(output);
+    if (!in.open(QIODevice::ReadOnly))
+        return Fail(QString::fromUtf8("无法打开输入文件:")+in.errorString());
+
+    const QByteArray head = in.read(header_bytes);
+    const unsigned char *header = reinterpret_cast<const unsigned char*>(head.constData());
+    if (head.size() != header_bytes || !std::equal(file_magic, file_magic+4, head.constData())
+            || header[4] != file_version)
+        return Fail(QString::fromUtf8("不是RSA混合加密文件"));
+    const uint32_t size = (uint32_t)GetWord(header+8, 4);
+    const uint64_t total = GetWord(header+12, 8);
+    const int wrapped_bytes = (int)GetWord(header+20, 4);
+    if (size < min_chunk || size > max_chunk || wrapped_bytes != rsa.CipherBlockBytes() || rsa.KeyBlockBytes() < session_bytes)
+        return Fail(QString::fromUtf8("文件头与当前密钥不符"));
+    const uint64_t chunks = std::max<uint64_t>(1, total/size+(total%size != 0));
+    const uint64_t start = header_bytes+wrapped_bytes;
+    if (total > (uint64_t)in.size() || (uint64_t)in.size() != start+total+chunks*tag_bytes)
+        return Fail(QString::fromUtf8("文件长度不正确,可能已被截断"));
+
+    const QByteArray secret = rsa.UnwrapKey(in.read(wrapped_bytes), rsa.KeyBlockBytes());
+    if (secret.size() < session_bytes)
+        return Fail(QString::fromUtf8("无法解开会话密钥"));
+    uint32_t key[8];
+    ChaCha20::LoadKey(reinterpret_cast<const unsigned char*>(secret.constData()), key);
+
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return Fail(QString::fromUtf8("无法创建输出文件:")+out.errorString());
+    std::vector<unsigned char> buffer((size_t)std::min<uint64_t>(size, total));
+    for (uint64_t i = 0; i < chunks; ++i) {
+        const size_t len = (size_t)std::min<uint64_t>(size, total-i*size);
+        uchar *src = in.map(start+i*(size+tag_bytes), len+tag_bytes);
+        if (!src) {
+            out.remove();
+            return Fail(QString::fromUtf8("无法映射输入文件:")+in.errorString());
+        }
+        unsigned char tag[tag_bytes];
+        ChunkTag(key, i, i+1 == chunks, src, len, tag);
+        const bool ok = Poly1305::Equal(tag, src+len);
+        if (ok)
+            ChaCha20::Crypt(key, i, 1, src, buffer.data(), len);
+        in.unmap(src);
+        if (!ok) {
+            out.remove();
+            return Fail(QString::fromUtf8("第%1块认证失败,文件已损坏或密钥不符").arg(i));
+        }
+        if (out.write(reinterpret_cast<const char*>(buffer.data()), len) != qint64(len)) {
+            out.remove();
+            return Fail(QString::fromUtf8("写入失败:")+out.errorString());
+        }
+        if (progress)
+            progress((double)(i+1)/(double)chunks);
+    }
+    return true;
+}
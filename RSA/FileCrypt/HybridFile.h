@@ -0,0 +1,39 @@
+#ifndef HYBRIDFILE_H
+#define HYBRIDFILE_H
+#include <QString>
+#include <cstdint>
+#include <functional>
+#include "RSA_Encryption.h"
+
+/**
+ * RSA混合加密的文件格式:随机生成的会话密钥用RSA公钥包装后写在文件头,
+ * 文件内容按固定大小分块,每块用ChaCha20加密并附带Poly1305认证码。
+ * 输入文件按块做内存映射,加解密过程只占用一个块的缓冲区,与文件大小无关。
+ *
+ * 文件格式(整数均为大端序):
+ *   "RSAF" | 版本(1字节) | 保留(3字节) | 块大小(4字节) | 明文长度(8字节)
+ *   | 包装后的密钥长度(4字节) | 包装后的密钥
+ *   | 若干块:密文 + 16字节认证码
+ * 第i块使用流编号i,0号分组的密钥流作为Poly1305的一次性密钥,之后的密钥流用于加密;
+ * 认证码覆盖密文、块长度、块序号和是否为最后一块,删除、调换或截断块都能被发现。
+ * 空文件也有一个空的最后块
+ */
+class HybridFile
+{
+public:
+    explicit HybridFile(RSA_Encryption &rsa, uint32_t chunk = 1u<<20);    // 块大小限制在64字节到64MiB之间
+
+    bool Encrypt(const QString &input, const QString &output);    // 需要公钥,失败时删除输出文件
+    bool Decrypt(const QString &input, const QString &output);    // 需要私钥,任一块认证失败时删除输出文件
+    QString ErrorString() const { return error; }
+    void SetProgress(const std::function<void(double)> &callback) { progress = callback; }
+private:
+    RSA_Encryption &rsa;
+    uint32_t chunk;    // 块大小
+    QString error;    // 最近一次失败的原因
+    std::function<void(double)> progress;    // 进度回调,可为空
+
+    bool Fail(const QString &reason);    // 记录失败原因并返回false
+};
+
+#endif // HYBRIDFILE_H
@@ -0,0 +1,68 @@
+/**
+ * RSA混合文件加密工具,不需要图形界面。
+ * 用法:FileCrypt keygen <素数位数> <密钥文件>
+ *       FileCrypt encrypt <密钥文件> <输入文件> <输出文件>
+ *       FileCrypt decrypt <密钥文件> <输入文件> <输出文件>
+ * 成功时返回0,失败时在标准错误输出原因并返回1
+ */
+#include <QCoreApplication>
+#include <QStringList>
+#include <cstdio>
+#include "HybridFile.h"
+#include "RSA_Encryption.h"
+
+static int Usage()
+{
+    std::fprintf(stderr, "usage: FileCrypt keygen <prime bits> <keyfile>\n"
+                         "       FileCrypt encrypt <keyfile> <input> <output>\n"
+                         "       FileCrypt decrypt <keyfile> <input> <output>\n");
+    return 1;
+}
+
+static void ShowProgress(double progress)
+{
+    std::fprintf(stderr, "\r%5.1f%%", progress*100);
+    if (progress >= 1)
+        std::fprintf(stderr, "\n");
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    const QStringList args = a.arguments();
+    if (args.size() < 4)
+        return Usage();
+    const QString command = args[1];
+    RSA_Encryption rsa;
+
+    if (command == "keygen" && args.size() == 4) {
+        bool ok = false;
+        const unsigned int bits = args[2].toUInt(&ok);
+        if (!ok || bits < 256)    // 会话密钥需要至少32字节的明文分组
+            return Usage();
+        rsa.Initial(bits);
+        if (!rsa.GenearteKey()) {
+            std::fprintf(stderr, "no reliable random source, key not generated\n");
+            return 1;
+        }
+        if (!rsa.SaveKey(args[3])) {
+            std::fprintf(stderr, "cannot write key file %s\n", qPrintable(args[3]));
+            return 1;
+        }
+        return 0;
+    }
+    if ((command != "encrypt" && command != "decrypt") || args.size() != 5)
+        return Usage();
+    if (!rsa.LoadKey(args[2])) {
+        std::fprintf(stderr, "cannot load key file %s\n", qPrintable(args[2]));
+        return 1;
+    }
+    HybridFile file(rsa);
+    file.SetProgress(ShowProgress);
+    const bool ok = command == "encrypt" ? file.Encrypt(args[3], args[4]) : file.Decrypt(args[3], args[4]);
+    if (!ok) {
+        std::fprintf(stderr, "%s\n", file.ErrorString().toLocal8Bit().constData());
+        return 1;
+    }
+    return 0;
+}
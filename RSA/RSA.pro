@@ -8,9 +8,15 @@ QT       += core gui
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
+# FixedBigInt uses std::index_sequence.
+CONFIG   += c++14
+
 TARGET = RSA
 TEMPLATE = app
 
+# ChaCha20 reads its seed from RtlGenRandom.
+win32: LIBS += -ladvapi32
+
 # The following define makes your compiler emit warnings if you use
 # any feature of Qt which has been marked as deprecated (the exact warnings
 # depend on your compiler). Please consult the documentation of the
@@ -22,17 +28,37 @@ DEFINES += QT_DEPRECATED_WARNINGS
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+# Check every CRT decryption against the plain modPow result (debug only).
+#DEFINES += RSA_CRT_SELF_CHECK
+
+# Compute the private exponent and q^-1 mod p with the constant-time inverse.
+#DEFINES += RSA_CONSTANT_TIME_INVERSE
+
 
 SOURCES += \
         main.cpp \
         Widget.cpp \
+    Algorithm/Barrett.cpp \
     Algorithm/BigInteger.cpp \
-    Algorithm/RSA_Encryption.cpp
+    Algorithm/ChaCha20.cpp \
+    Algorithm/LimbPool.cpp \
+    Algorithm/Montgomery.cpp \
+    Algorithm/RSA_Encryption.cpp \
+    Algorithm/RSA_Key.cpp \
+    Algorithm/WorkerPool.cpp
 
 HEADERS += \
         Widget.h \
+    Algorithm/Barrett.h \
     Algorithm/BigInteger.h \
-    Algorithm/RSA_Encryption.h
+    Algorithm/ChaCha20.h \
+    Algorithm/FixedBigInt.h \
+    Algorithm/InlineVector.h \
+    Algorithm/LimbPool.h \
+    Algorithm/Montgomery.h \
+    Algorithm/RSA_Encryption.h \
+    Algorithm/RSA_Key.h \
+    Algorithm/WorkerPool.h
 
 FORMS += \
         Widget.ui
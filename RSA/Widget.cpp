@@ -30,6 +30,11 @@ void Widget::on_pushButtonGenerate_clicked()
     QString str = ui->LineEditLength->text();
     int num = str.toInt();
     algorithm->Initial(num);
+    if(!algorithm->GenearteKey()){
+       QMessageBox::warning(this,tr("警告"),
+                            tr("没有可靠的随机数源,无法生成密钥!!!"));
+       return;
+    }
     ui->LineEditPublic->setText(QString(algorithm->GetPublicKey()));
     ui->LineEditPrivate->setText(QString(algorithm->GetPrivateKey()));
 }